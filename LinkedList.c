@@ -9,6 +9,7 @@
 LinkedList *createLinkedList() {
     LinkedList *list = malloc(sizeof(LinkedList));
     assertMemoryAllocation(list);
+    list->first = NULL;
     list->length = 0;
     return list;
 }
@@ -94,3 +95,40 @@ void removeItem(LinkedList *list, LinkedListNode *item) {
     free(item);
     list->length--;
 }
+
+/**
+ * Compares two groups by their first vertex.
+ * @param a a pointer to a VerticesGroup pointer.
+ * @param b a pointer to a VerticesGroup pointer.
+ * @return a negative number, zero or a positive number if a's first vertex is smaller, equal or bigger than b's.
+ */
+static int compareGroupsByFirstVertex(const void *a, const void *b) {
+    int x = (*(VerticesGroup * const *) a)->verticesArr[0];
+    int y = (*(VerticesGroup * const *) b)->verticesArr[0];
+    return (x > y) - (x < y);
+}
+
+/**
+ * Sorts a GROUP list by the first vertex of every group, so that a division has a single canonical order.
+ * @param groupList a linked list, containing pointers to non-empty VerticesGroups.
+ */
+void sortGroupList(LinkedList *groupList) {
+    VerticesGroup **groups;
+    LinkedListNode *node = groupList->first;
+    int i;
+    if (groupList->length < 2) {
+        return;
+    }
+    groups = malloc(groupList->length * sizeof(VerticesGroup *));
+    assertMemoryAllocation(groups);
+    for (i = 0; i < groupList->length; ++i) {
+        groups[i] = node->pointer;
+        node = node->next;
+    }
+    qsort(groups, groupList->length, sizeof(VerticesGroup *), compareGroupsByFirstVertex);
+    for (i = 0; i < groupList->length; ++i) {
+        node->pointer = groups[i];
+        node = node->next;
+    }
+    free(groups);
+}
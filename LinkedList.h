@@ -23,4 +23,6 @@ void *insertItem(LinkedList *list, void *pointer);
 
 void removeItem(LinkedList *list, LinkedListNode *item);
 
+void sortGroupList(LinkedList *groupList);
+
 #endif
@@ -4,6 +4,7 @@
 #include "VerticesGroup.h"
 #include "defs.h"
 #include "ErrorHandler.h"
+#include "stats.h"
 
 /**
  * Create a group of vertices
@@ -20,6 +21,8 @@ VerticesGroup *createVerticesGroup(unsigned int capacity) {
     group->modularityRowSums = NULL;
     group->modularityAbsColSum = NULL;
     group->size = 0;
+    group->depth = 0;
+    group->treeNode = -1;
     return group;
 }
 
@@ -56,6 +59,119 @@ void addVertexToGroup(VerticesGroup *group, int index) {
     ++group->size;
 }
 
+static int compareInts(const void *a, const void *b) {
+    int x = *(const int *) a, y = *(const int *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Count the neighbors of every vertex inside its group, or sum the weights of their edges if weighted is set.
+ * The vertices of the group are in increasing order, so they are searched by bisection.
+ * @param G graph object
+ * @param group vertices group
+ * @param counts an allocated array of capacity group->size, will be assigned the counts
+ * @param weighted whether the weights of the edges are summed, instead of the neighbors counted
+ */
+static void countInnerEdges(Graph *G, VerticesGroup *group, int *counts, int weighted) {
+    nodeRef *rows = (nodeRef *) G->adjMat->private;
+    nodeRef neighbor;
+    int i;
+    for (i = 0; i < group->size; i++) {
+        counts[i] = 0;
+        for (neighbor = rows[group->verticesArr[i]]; neighbor != NULL; neighbor = neighbor->next) {
+            if (bsearch(&neighbor->colind, group->verticesArr, group->size, sizeof(int), compareInts) != NULL) {
+                counts[i] += weighted ? (int) neighbor->value : 1;
+            }
+        }
+    }
+}
+
+/**
+ * Calculate the degree of every vertex inside its group: the weights of its edges inside the group, which is the
+ * number of its neighbors there unless the graph is weighted (see twins.h).
+ * @param G graph object
+ * @param group vertices group, its vertices in increasing order
+ * @param innerDegrees an allocated array of capacity group->size, will be assigned the inner degrees
+ */
+void countInnerDegrees(Graph *G, VerticesGroup *group, int *innerDegrees) {
+    countInnerEdges(G, group, innerDegrees, 1);
+}
+
+/**
+ * List the neighbors of every vertex inside its group, by their positions in the group (compressed sparse rows).
+ * @param G graph object
+ * @param group vertices group
+ * @param offsets an allocated array of capacity group->size+1, will be assigned the first neighbor of every vertex
+ * @return the positions of the neighbors, in increasing order for every vertex (to be freed by the caller)
+ */
+int *listInnerNeighbors(Graph *G, VerticesGroup *group, int *offsets) {
+    nodeRef *rows = (nodeRef *) G->adjMat->private;
+    nodeRef neighbor;
+    int i, *position, *neighbors;
+    countInnerEdges(G, group, offsets + 1, 0);
+    offsets[0] = 0;
+    for (i = 0; i < group->size; i++) {
+        offsets[i + 1] += offsets[i];
+    }
+    neighbors = malloc((offsets[group->size] > 0 ? offsets[group->size] : 1) * sizeof(int));
+    assertMemoryAllocation(neighbors);
+    for (i = 0; i < group->size; i++) {
+        for (neighbor = rows[group->verticesArr[i]]; neighbor != NULL; neighbor = neighbor->next) {
+            position = bsearch(&neighbor->colind, group->verticesArr, group->size, sizeof(int), compareInts);
+            if (position != NULL) {
+                neighbors[offsets[i]++] = (int) (position - group->verticesArr);
+            }
+        }
+    }
+    /* every offset was moved to the next vertex's one */
+    for (i = group->size; i > 0; i--) {
+        offsets[i] = offsets[i - 1];
+    }
+    offsets[0] = 0;
+    return neighbors;
+}
+
+/**
+ * Construct the subgraph induced by a group: its vertices, and the edges between them.
+ * The vertices are relabeled by their positions in the group, and originalIndices maps them back.
+ * @param G graph object
+ * @param group vertices group, whose vertices are in increasing order
+ * @return a new graph object (to be freed by destroyGraph)
+ */
+Graph *constructInducedGraph(Graph *G, VerticesGroup *group) {
+    Graph *subgraph = malloc(sizeof(Graph));
+    int i, k, *offsets = malloc((group->size + 1) * sizeof(int)), *neighbors;
+    double *row = calloc(group->size, sizeof(double));
+    assertMemoryAllocation(subgraph);
+    assertMemoryAllocation(offsets);
+    assertMemoryAllocation(row);
+    subgraph->n = group->size;
+    subgraph->degreeSum = 0;
+    subgraph->degrees = malloc(group->size * sizeof(int));
+    assertMemoryAllocation(subgraph->degrees);
+    subgraph->originalIndices = malloc(group->size * sizeof(int));
+    assertMemoryAllocation(subgraph->originalIndices);
+    subgraph->adjMat = spmat_allocate_list(group->size);
+
+    neighbors = listInnerNeighbors(G, group, offsets);
+    for (i = 0; i < group->size; i++) {
+        subgraph->originalIndices[i] = group->verticesArr[i];
+        subgraph->degrees[i] = offsets[i + 1] - offsets[i];
+        subgraph->degreeSum += subgraph->degrees[i];
+        for (k = offsets[i]; k < offsets[i + 1]; k++) {
+            row[neighbors[k]] = 1;
+        }
+        subgraph->adjMat->add_row(subgraph->adjMat, row, i);
+        for (k = offsets[i]; k < offsets[i + 1]; k++) {
+            row[neighbors[k]] = 0;
+        }
+    }
+    free(neighbors);
+    free(offsets);
+    free(row);
+    return subgraph;
+}
+
 /**
  * Get the 1-norm of the modularity matrix
  * @param group vertices group
@@ -66,17 +182,18 @@ double getModularityMatrixNorm1(VerticesGroup *group) {
 }
 
 /**
- * Calculate the modularity sub matrix in the VerticesGroup object
+ * Fill the modularity sub matrix in the VerticesGroup object
  * @param G graph object
  * @param group vertices group containing the modularity sub matrix
+ * @param edgeSubMatrix an empty sparse matrix of the group's size, will be assigned the group's edges
  */
-void calculateModularitySubMatrix(Graph *G, VerticesGroup *group) {
+static void fillModularitySubMatrix(Graph *G, VerticesGroup *group, spmat *edgeSubMatrix) {
     double *row, modularityEntry;
     nodeRef *rowLists, spmNode;
     int i = 0, j, con;
     if (group->size != 0) {
         rowLists = (nodeRef *) G->adjMat->private;
-        group->edgeSubMatrix = spmat_allocate_list(group->size);
+        group->edgeSubMatrix = edgeSubMatrix;
         assertMemoryAllocation(group->edgeSubMatrix);
         group->modularityRowSums = calloc(group->size, sizeof(double));
         assertMemoryAllocation(group->modularityRowSums);
@@ -94,7 +211,7 @@ void calculateModularitySubMatrix(Graph *G, VerticesGroup *group) {
                         row[j] = 0;
                         con = 0;
                     } else if (spmNode->colind == group->verticesArr[j]) {
-                        row[j] = 1;
+                        row[j] = spmNode->value;
                         con = 0;
                     } else {
                         spmNode = spmNode->next;
@@ -124,6 +241,29 @@ void calculateModularitySubMatrix(Graph *G, VerticesGroup *group) {
     }
 }
 
+/**
+ * Calculate the modularity sub matrix in the VerticesGroup object, keeping the group's edges in linked lists
+ * @param G graph object
+ * @param group vertices group containing the modularity sub matrix
+ */
+void calculateModularitySubMatrix(Graph *G, VerticesGroup *group) {
+    if (group->size != 0) {
+        fillModularitySubMatrix(G, group, spmat_allocate_list(group->size));
+    }
+}
+
+/**
+ * Calculate the modularity sub matrix in the VerticesGroup object, keeping only the upper triangle of the
+ * group's edges (see spmat_allocate_symmetric), which takes half the memory
+ * @param G graph object
+ * @param group vertices group containing the modularity sub matrix
+ */
+void calculateSymmetricModularitySubMatrix(Graph *G, VerticesGroup *group) {
+    if (group->size != 0) {
+        fillModularitySubMatrix(G, group, spmat_allocate_symmetric(group->size, group->size));
+    }
+}
+
 /**
  * Multiply the modularity matrix of a sub group of vertices by an eigenvector: s_t*B*s
  * @param group the vertices group of the modularity matrix
@@ -142,6 +282,7 @@ double multiplyModularityByVector(Graph *G, VerticesGroup *group, double *s, dou
     double modularityNorm1 = withNorm ? getModularityMatrixNorm1(group) : 0;
     double f;
 
+    STATS_COUNT(STATS_COUNTER_MAT_VECS, group->depth, 1);
     /* multiply A by s */
     group->edgeSubMatrix->mult(group->edgeSubMatrix, s, res);
     for (i = 0; i < group->size; i++) {
@@ -195,6 +336,7 @@ double powerIteration(Graph *G, VerticesGroup *group, double *vector, double *ve
     int i, con = 1;
     double vectorNorm, dif, lambda, x, y;
     while (con) {
+        STATS_COUNT(STATS_COUNTER_POWER_ITERATIONS, group->depth, 1);
         x = y = 0;
         vectorNorm = multiplyModularityByVector(G, group, vector, vectorResult, 0, 1, 1);
         con = 0;
@@ -215,3 +357,104 @@ double powerIteration(Graph *G, VerticesGroup *group, double *vector, double *ve
     lambda -= getModularityMatrixNorm1(group);
     return lambda;
 }
+
+/**
+ * Perform the power iteration algorithm, stopping as soon as the division it implies is settled:
+ * the signs of the vector did not change for a number of iterations, and the Rayleigh quotient is stable.
+ * The division is polished by the refinement anyway, so the vector does not have to converge entry by entry.
+ * Stops no later than powerIteration does.
+ * @param group a vertices group, containing the modularity sub matrix
+ * @param vector initial vector for the algorithm
+ * @param vectorResult the last vector of the algorithm, should be allocated
+ * @param stableIterations the number of iterations the signs should stay unchanged
+ * @return the Rayleigh quotient of the last vector (with respect to the un-shifted B_hat).
+ */
+double powerIterationUntilStableSigns(Graph *G, VerticesGroup *group, double *vector, double *vectorResult,
+                                      int stableIterations) {
+    int i, con = 1, stableCount = 0, signsChanged, isPositive;
+    double vectorNorm, dif, x, y, quotient = 0, previousQuotient;
+    char *signs = calloc(group->size, sizeof(char));
+    assertMemoryAllocation(signs);
+    while (con) {
+        STATS_COUNT(STATS_COUNTER_POWER_ITERATIONS, group->depth, 1);
+        x = y = 0;
+        vectorNorm = multiplyModularityByVector(G, group, vector, vectorResult, 0, 1, 1);
+        con = 0;
+        signsChanged = 0;
+        for (i = 0; i < group->size; i++) {
+            x += vector[i] * vectorResult[i];
+            y += vector[i] * vector[i];
+            vectorResult[i] /= vectorNorm;
+            dif = fabs(vectorResult[i] - vector[i]);
+            if (IS_POSITIVE(dif)) {
+                con = 1;
+            }
+            isPositive = IS_POSITIVE(vectorResult[i]);
+            if (isPositive != signs[i]) {
+                signs[i] = (char) isPositive;
+                signsChanged = 1;
+            }
+            vector[i] = vectorResult[i];
+        }
+        previousQuotient = quotient;
+        quotient = x / y;
+        stableCount = signsChanged ? 0 : stableCount + 1;
+        if (stableCount >= stableIterations && !IS_POSITIVE(fabs(quotient - previousQuotient))) {
+            con = 0;
+        }
+    }
+    free(signs);
+
+    /* the eigenvalue estimate with respect to the un-shifted B_hat */
+    return quotient - getModularityMatrixNorm1(group);
+}
+
+/**
+ * Calculate the modularity sub matrix in the VerticesGroup object, keeping the group's edges compressed
+ * (see spmat_allocate_compressed), which takes a few bytes per edge
+ * @param G graph object
+ * @param group vertices group containing the modularity sub matrix
+ */
+void calculateCompressedModularitySubMatrix(Graph *G, VerticesGroup *group) {
+    if (group->size != 0) {
+        fillModularitySubMatrix(G, group, spmat_allocate_compressed(group->size, group->size));
+    }
+}
+
+/**
+ * Calculate the modularity sub matrix in the VerticesGroup object, keeping the group's edges in the sliced ELLPACK
+ * format (see spmat_allocate_sell), with chunks as high as the processor's SIMD width
+ * @param G graph object
+ * @param group vertices group containing the modularity sub matrix
+ */
+void calculateSellModularitySubMatrix(Graph *G, VerticesGroup *group) {
+    if (group->size != 0) {
+        fillModularitySubMatrix(G, group,
+                                spmat_allocate_sell(group->size, spmat_sell_chunk_height(), SELL_DEFAULT_SIGMA));
+    }
+}
+
+/**
+ * Calculate the modularity sub matrix in the VerticesGroup object, keeping the group's edges in the arrays format,
+ * multiplied by several threads which share the non-zero values evenly (see spmat_allocate_merge_path)
+ * @param G graph object
+ * @param group vertices group containing the modularity sub matrix
+ * @param threads the largest number of threads of a multiplication
+ */
+void calculateMergePathModularitySubMatrix(Graph *G, VerticesGroup *group, int threads) {
+    if (group->size != 0) {
+        fillModularitySubMatrix(G, group, spmat_allocate_merge_path(group->size, threads));
+    }
+}
+
+/**
+ * Calculate the modularity sub matrix in the VerticesGroup object, keeping the group's edges as a bit matrix
+ * (see spmat_allocate_bitset), which suits dense groups
+ * @param G graph object
+ * @param group vertices group containing the modularity sub matrix
+ */
+void calculateBitsetModularitySubMatrix(Graph *G, VerticesGroup *group) {
+    if (group->size != 0) {
+        fillModularitySubMatrix(G, group, spmat_allocate_bitset(group->size));
+    }
+}
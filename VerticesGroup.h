@@ -12,6 +12,10 @@ typedef struct verticesGroup {
     double *modularityRowSums;
     double *modularityAbsColSum;
     int highestColSumIndex;
+    /* depth of the group in the bisection tree (the whole graph is at depth 0) */
+    int depth;
+    /* the node of the group in the dendrogram of the division (see dendrogram.h), -1 if it has none */
+    int treeNode;
 
 } VerticesGroup;
 
@@ -23,8 +27,24 @@ void freeVerticesGroupModularitySubMatrix(VerticesGroup *group);
 
 void addVertexToGroup(VerticesGroup *group, int index);
 
+void countInnerDegrees(Graph *G, VerticesGroup *group, int *innerDegrees);
+
+int *listInnerNeighbors(Graph *G, VerticesGroup *group, int *offsets);
+
+Graph *constructInducedGraph(Graph *G, VerticesGroup *group);
+
 void calculateModularitySubMatrix(Graph *G, VerticesGroup *group);
 
+void calculateSymmetricModularitySubMatrix(Graph *G, VerticesGroup *group);
+
+void calculateCompressedModularitySubMatrix(Graph *G, VerticesGroup *group);
+
+void calculateSellModularitySubMatrix(Graph *G, VerticesGroup *group);
+
+void calculateMergePathModularitySubMatrix(Graph *G, VerticesGroup *group, int threads);
+
+void calculateBitsetModularitySubMatrix(Graph *G, VerticesGroup *group);
+
 double multiplyModularityByVector(Graph *G, VerticesGroup *group, double *s, double *res, int bothSides, int withNorm,
                                   int withF);
 
@@ -34,4 +54,7 @@ double getModularityMatrixNorm1(VerticesGroup *group);
 
 double powerIteration(Graph *G, VerticesGroup *group, double *vector, double *vectorResult);
 
+double powerIterationUntilStableSigns(Graph *G, VerticesGroup *group, double *vector, double *vectorResult,
+                                      int stableIterations);
+
 #endif
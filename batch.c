@@ -0,0 +1,210 @@
+#include <stdlib.h>
+#include <math.h>
+#include "batch.h"
+#include "indivisible.h"
+#include "defs.h"
+#include "ErrorHandler.h"
+#include "stats.h"
+
+/**
+ * Pack the sub matrices of several groups into one block-diagonal matrix, in the arrays (CSR) format.
+ * The modularity sub matrices of the groups should be calculated already.
+ * @param groups the groups to pack
+ * @param count the number of groups
+ * @param offsets an allocated array of capacity count+1, will be assigned the first row of every block
+ * @return the block-diagonal matrix
+ */
+spmat *buildBlockDiagonalMatrix(VerticesGroup **groups, int count, int *offsets) {
+    spmat *blocks;
+    csr *arrays;
+    nodeRef *rowLists, spmNode;
+    int g, i, nnz = 0, row = 0;
+
+    offsets[0] = 0;
+    for (g = 0; g < count; g++) {
+        offsets[g + 1] = offsets[g] + groups[g]->size;
+        rowLists = (nodeRef *) groups[g]->edgeSubMatrix->private;
+        for (i = 0; i < groups[g]->size; i++) {
+            for (spmNode = rowLists[i]; spmNode != NULL; spmNode = spmNode->next) {
+                nnz++;
+            }
+        }
+    }
+
+    blocks = spmat_allocate_array(offsets[count], nnz);
+    arrays = (csr *) blocks->private;
+    nnz = 0;
+    for (g = 0; g < count; g++) {
+        rowLists = (nodeRef *) groups[g]->edgeSubMatrix->private;
+        for (i = 0; i < groups[g]->size; i++) {
+            for (spmNode = rowLists[i]; spmNode != NULL; spmNode = spmNode->next) {
+                arrays->values[nnz] = spmNode->value;
+                arrays->colind[nnz] = offsets[g] + spmNode->colind;
+                nnz++;
+            }
+            arrays->rowptr[++row] = nnz;
+        }
+    }
+    return blocks;
+}
+
+/**
+ * Perform the power iteration algorithm on several groups at once.
+ * Every step multiplies the blocks of the groups which did not converge yet by their vectors,
+ * so a converged group costs nothing from then on.
+ * @param G graph object
+ * @param groups the groups, containing their modularity sub matrices
+ * @param count the number of groups
+ * @param offsets the first row of every group's block, as assigned by buildBlockDiagonalMatrix
+ * @param blocks the block-diagonal matrix of the groups
+ * @param vector the concatenated initial vectors of the groups
+ * @param vectorResult the concatenated eigenvectors found by the algorithm, should be allocated
+ * @param lambdas an allocated array of capacity count, will be assigned the eigenvalues (of the un-shifted B_hat)
+ */
+void batchPowerIteration(Graph *G, VerticesGroup **groups, int count, int *offsets, spmat *blocks, double *vector,
+                         double *vectorResult, double *lambdas) {
+    csr *arrays = (csr *) blocks->private;
+    register int *rowptr = arrays->rowptr, *colind = arrays->colind;
+    register double *values = arrays->values;
+    register int k, row;
+    register double sum;
+    int *active, *vertices, *degrees = G->degrees;
+    double *norms, *rowSums;
+    int g, a, i, first, last, activeCount = count, stillActive, con;
+    double norm, degreesCommon, squares, x, y, vectorNorm, dif;
+
+    active = malloc(count * sizeof(int));
+    assertMemoryAllocation(active);
+    norms = malloc(count * sizeof(double));
+    assertMemoryAllocation(norms);
+    for (g = 0; g < count; g++) {
+        active[g] = g;
+        norms[g] = getModularityMatrixNorm1(groups[g]);
+    }
+
+    while (activeCount > 0) {
+        stillActive = 0;
+        for (a = 0; a < activeCount; a++) {
+            g = active[a];
+            STATS_COUNT(STATS_COUNTER_POWER_ITERATIONS, groups[g]->depth, 1);
+            STATS_COUNT(STATS_COUNTER_MAT_VECS, groups[g]->depth, 1);
+            /* the block's fields are kept in locals, as the loops below run once per row of every step */
+            vertices = groups[g]->verticesArr;
+            rowSums = groups[g]->modularityRowSums;
+            norm = norms[g];
+            first = offsets[g];
+            last = offsets[g + 1];
+
+            /* multiply the block by its vector, adding the shift and subtracting f (the row sums) */
+            degreesCommon = 0;
+            for (row = first, i = 0; row < last; row++, i++) {
+                sum = 0;
+                for (k = rowptr[row]; k < rowptr[row + 1]; k++) {
+                    sum += vector[colind[k]] * values[k];
+                }
+                degreesCommon += (double) degrees[vertices[i]] * vector[row];
+                vectorResult[row] = sum + (norm - rowSums[i]) * vector[row];
+            }
+
+            /* subtract the expected edges (K) part, which is common to all the rows of a group up to the degree */
+            squares = 0;
+            for (row = first, i = 0; row < last; row++, i++) {
+                vectorResult[row] -= (double) degrees[vertices[i]] * degreesCommon / G->degreeSum;
+                squares += vectorResult[row] * vectorResult[row];
+            }
+
+            /* normalize the vector, and let the group leave the batch once it converged */
+            vectorNorm = sqrt(squares);
+            x = y = 0;
+            con = 0;
+            for (row = first; row < last; row++) {
+                x += vector[row] * vectorResult[row];
+                y += vector[row] * vector[row];
+                vectorResult[row] /= vectorNorm;
+                dif = fabs(vectorResult[row] - vector[row]);
+                if (IS_POSITIVE(dif)) {
+                    con = 1;
+                }
+                vector[row] = vectorResult[row];
+            }
+            if (con) {
+                active[stillActive++] = g;
+            } else {
+                lambdas[g] = x / y - norm;
+            }
+        }
+        activeCount = stillActive;
+    }
+
+    free(active);
+    free(norms);
+}
+
+/**
+ * Divide several groups of the sparse engine, solving their eigenproblems together.
+ * Every group is divided exactly as divisionAlgorithm2 would divide it, including the indivisibility pre-checks.
+ * @param G graph object
+ * @param settings division settings
+ * @param groups the groups to divide, their vertices should be disjoint
+ * @param count the number of groups
+ * @param vector an empty allocated array the capacity of the graph's vertices, used for power iteration
+ * @param s an empty allocated array the capacity of the graph's vertices, used for storing the eigenvectors
+ * @param newGroupsA an allocated array of capacity count, will be assigned the first divided groups (or NULL)
+ * @param newGroupsB an allocated array of capacity count, will be assigned the second divided groups (or NULL)
+ */
+void batchDivisionAlgorithm(Graph *G, DivisionSettings *settings, VerticesGroup **groups, int count, double *vector,
+                            double *s, VerticesGroup **newGroupsA, VerticesGroup **newGroupsB) {
+    int g, j, solvedCount = 0, *offsets, *solvedIndices;
+    double *lambdas;
+    VerticesGroup **solved;
+    spmat *blocks;
+    Rng rng;
+
+    offsets = malloc((count + 1) * sizeof(int));
+    assertMemoryAllocation(offsets);
+    lambdas = malloc(count * sizeof(double));
+    assertMemoryAllocation(lambdas);
+    solved = malloc(count * sizeof(VerticesGroup *));
+    assertMemoryAllocation(solved);
+    solvedIndices = malloc(count * sizeof(int));
+    assertMemoryAllocation(solvedIndices);
+
+    for (g = 0; g < count; g++) {
+        newGroupsA[g] = NULL;
+        newGroupsB[g] = NULL;
+        STATS_COUNT(STATS_COUNTER_GROUPS, groups[g]->depth, 1);
+        if (settings->preChecks && isIndivisibleGroup(G, groups[g])) {
+            STATS_COUNT(STATS_COUNTER_REJECTED_PRECHECK, groups[g]->depth, 1);
+            continue;
+        }
+        STATS_START(STATS_PHASE_SUBMATRIX);
+        calculateModularitySubMatrix(G, groups[g]);
+        STATS_STOP(STATS_PHASE_SUBMATRIX, groups[g]->depth);
+        solvedIndices[solvedCount] = g;
+        solved[solvedCount++] = groups[g];
+    }
+
+    if (solvedCount > 0) {
+        STATS_START(STATS_PHASE_EIGEN);
+        blocks = buildBlockDiagonalMatrix(solved, solvedCount, offsets);
+        /* the groups are disjoint, so their concatenated vectors fit in the arrays of the graph's capacity */
+        for (j = 0; j < solvedCount; j++) {
+            seedRng(&rng, settings->seed, solved[j]->verticesArr[0], solved[j]->size);
+            randVector(vector + offsets[j], solved[j]->size, &rng);
+        }
+        batchPowerIteration(G, solved, solvedCount, offsets, blocks, vector, s, lambdas);
+        blocks->free(blocks);
+        /* the batch mixes depths, so its time is not attributed to any of them */
+        STATS_STOP(STATS_PHASE_EIGEN, -1);
+    }
+
+    for (j = 0; j < solvedCount; j++) {
+        g = solvedIndices[j];
+        divideByLeadingEigenvector(G, groups[g], lambdas[j], s + offsets[j], &newGroupsA[g], &newGroupsB[g]);
+    }
+
+    free(offsets);
+    free(lambdas);
+    free(solved);
+    free(solvedIndices);
+}
@@ -0,0 +1,24 @@
+#ifndef CLUSTER_BATCH_H
+#define CLUSTER_BATCH_H
+
+#include "graph.h"
+#include "VerticesGroup.h"
+#include "division.h"
+
+/*
+ * Batched eigen-solve for many groups of the sparse engine.
+ * The sub matrices of the groups are packed into one block-diagonal matrix (compressed sparse rows),
+ * and the power iterations of all the groups advance together, one multiplication of the whole block per step.
+ * Norms, Rayleigh quotients and convergence are kept per group, and a group leaves the batch once its vector
+ * converges. Every group sees exactly the arithmetic of powerIteration, so the divisions are the same.
+ */
+
+spmat *buildBlockDiagonalMatrix(VerticesGroup **groups, int count, int *offsets);
+
+void batchPowerIteration(Graph *G, VerticesGroup **groups, int count, int *offsets, spmat *blocks, double *vector,
+                         double *vectorResult, double *lambdas);
+
+void batchDivisionAlgorithm(Graph *G, DivisionSettings *settings, VerticesGroup **groups, int count, double *vector,
+                            double *s, VerticesGroup **newGroupsA, VerticesGroup **newGroupsB);
+
+#endif
@@ -0,0 +1,176 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "chebyshev.h"
+#include "dense.h"
+#include "defs.h"
+#include "ErrorHandler.h"
+#include "stats.h"
+
+static double dotProduct(const double *a, const double *b, int n) {
+    int i;
+    double sum = 0;
+    for (i = 0; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+/**
+ * Scale a vector to a unit vector.
+ * @param vector the vector
+ * @param n the dimension
+ */
+static void normalize(double *vector, int n) {
+    int i;
+    double norm = sqrt(dotProduct(vector, vector, n));
+    for (i = 0; i < n; i++) {
+        vector[i] /= norm;
+    }
+}
+
+/**
+ * Estimate the spectrum of B_hat[g] by a few Lanczos steps.
+ * The Ritz values of the steps approach the extreme eigenvalues from within, and the last off-diagonal value bounds
+ * how far they can still be, so the smallest Ritz value minus it estimates the lower end of the spectrum.
+ * @param G graph object
+ * @param group a vertices group, containing the modularity sub matrix
+ * @param start the first Lanczos vector (before normalization), left unchanged
+ * @param q an allocated array of the group's size
+ * @param qPrevious an allocated array of the group's size
+ * @param w an allocated array of the group's size
+ * @param lowest will be assigned an estimate of the smallest eigenvalue (no smaller than minus the 1-norm)
+ * @param cut will be assigned the second largest Ritz value, below which the spectrum is damped
+ */
+void estimateSpectrum(Graph *G, VerticesGroup *group, double *start, double *q, double *qPrevious, double *w,
+                      double *lowest, double *cut) {
+    int i, count, steps = LANCZOS_STEPS < group->size ? LANCZOS_STEPS : group->size;
+    double alphas[LANCZOS_STEPS], betas[LANCZOS_STEPS], beta = 0, smallest, largest, second, *swap;
+
+    memcpy(q, start, group->size * sizeof(double));
+    normalize(q, group->size);
+    for (i = 0; i < group->size; i++) {
+        qPrevious[i] = 0;
+    }
+    for (count = 0; count < steps;) {
+        multiplyModularityByVector(G, group, q, w, 0, 0, 1);
+        alphas[count] = dotProduct(q, w, group->size);
+        for (i = 0; i < group->size; i++) {
+            w[i] -= alphas[count] * q[i] + beta * qPrevious[i];
+        }
+        beta = sqrt(dotProduct(w, w, group->size));
+        betas[count++] = beta;
+        if (!IS_POSITIVE(beta)) {
+            /* the Lanczos vectors span an invariant subspace, the Ritz values are exact */
+            break;
+        }
+        swap = qPrevious;
+        qPrevious = q;
+        q = w;
+        w = swap;
+        for (i = 0; i < group->size; i++) {
+            q[i] /= beta;
+        }
+    }
+
+    tridiagonalEigenvalues(alphas, betas, count);
+    smallest = largest = second = alphas[0];
+    for (i = 1; i < count; i++) {
+        if (alphas[i] > largest) {
+            second = largest;
+            largest = alphas[i];
+        } else if (alphas[i] > second || second == largest) {
+            second = alphas[i];
+        }
+        if (alphas[i] < smallest) {
+            smallest = alphas[i];
+        }
+    }
+    *cut = count > 1 ? second : largest;
+    *lowest = smallest - beta;
+    if (*lowest < -getModularityMatrixNorm1(group)) {
+        *lowest = -getModularityMatrixNorm1(group);
+    }
+}
+
+/**
+ * Perform a Chebyshev-filtered power iteration.
+ * Every step applies the Chebyshev polynomial of degree CHEBYSHEV_DEGREE of [lowest, cut], by its three-term
+ * recurrence, and then checks the residual with one more multiplication.
+ * The iteration stops when one step of the shifted power iteration would move no entry by more than epsilon,
+ * as in powerIteration. If the spectrum estimate proves wrong, it falls back to powerIteration.
+ * @param G graph object
+ * @param group a vertices group, containing the modularity sub matrix
+ * @param vector initial vector for the algorithm, is destroyed
+ * @param vectorResult the eigenvector found by the algorithm, should be allocated
+ * @return the eigenvalue of the eigenvector 'vectorResult' (with respect to the un-shifted B_hat).
+ */
+double chebyshevPowerIteration(Graph *G, VerticesGroup *group, double *vector, double *vectorResult) {
+    int i, degree, filters, con = 1, n = group->size;
+    double lowest, cut, center, halfWidth, lambda = 0, norm1 = getModularityMatrixNorm1(group);
+    double *previous, *current, *next, *swap;
+    double *temp = malloc(n * sizeof(double)), *spare = malloc(n * sizeof(double));
+    assertMemoryAllocation(temp);
+    assertMemoryAllocation(spare);
+
+    estimateSpectrum(G, group, vector, vectorResult, temp, spare, &lowest, &cut);
+    free(spare);
+    center = (cut + lowest) / 2;
+    halfWidth = (cut - lowest) / 2;
+    if (!IS_POSITIVE(halfWidth)) {
+        free(temp);
+        return powerIteration(G, group, vector, vectorResult);
+    }
+
+    /* the filter keeps three vectors: the two last terms of the recurrence, and the next one */
+    previous = vector;
+    current = vectorResult;
+    next = temp;
+    normalize(previous, n);
+    for (filters = 0; con && filters < CHEBYSHEV_MAX_FILTERS; filters++) {
+        STATS_COUNT(STATS_COUNTER_POWER_ITERATIONS, group->depth, 1);
+        multiplyModularityByVector(G, group, previous, current, 0, 0, 1);
+        for (i = 0; i < n; i++) {
+            current[i] = (current[i] - center * previous[i]) / halfWidth;
+        }
+        for (degree = 2; degree <= CHEBYSHEV_DEGREE; degree++) {
+            multiplyModularityByVector(G, group, current, next, 0, 0, 1);
+            for (i = 0; i < n; i++) {
+                next[i] = 2 * (next[i] - center * current[i]) / halfWidth - previous[i];
+            }
+            swap = previous;
+            previous = current;
+            current = next;
+            next = swap;
+        }
+        normalize(current, n);
+
+        /* the residual, scaled as the move of a shifted power iteration step */
+        multiplyModularityByVector(G, group, current, next, 0, 0, 1);
+        lambda = dotProduct(current, next, n);
+        con = 0;
+        for (i = 0; i < n && !con; i++) {
+            if (IS_POSITIVE(fabs(next[i] - lambda * current[i]) / (fabs(lambda) + norm1))) {
+                con = 1;
+            }
+        }
+        swap = previous;
+        previous = current;
+        current = swap;
+    }
+
+    /* the last filtered vector is in previous */
+    if (con || lambda < cut) {
+        /* no convergence, or convergence to the low end of the spectrum: the estimate was wrong */
+        if (previous != vector) {
+            memcpy(vector, previous, n * sizeof(double));
+        }
+        free(temp);
+        return powerIteration(G, group, vector, vectorResult);
+    }
+    if (previous != vectorResult) {
+        memcpy(vectorResult, previous, n * sizeof(double));
+    }
+    free(temp);
+    return lambda;
+}
@@ -0,0 +1,26 @@
+#ifndef CLUSTER_CHEBYSHEV_H
+#define CLUSTER_CHEBYSHEV_H
+
+#include "graph.h"
+#include "VerticesGroup.h"
+
+/* number of Lanczos steps estimating the spectrum of B_hat[g] */
+#define LANCZOS_STEPS 10
+/* degree of the Chebyshev polynomial applied between two convergence checks */
+#define CHEBYSHEV_DEGREE 8
+/* filter applications allowed before falling back to the shifted power iteration */
+#define CHEBYSHEV_MAX_FILTERS 1000
+
+/*
+ * Chebyshev-filtered power iteration.
+ * Instead of shifting B_hat[g] by its 1-norm, a few Lanczos steps estimate its spectrum: an interval [lowest, cut]
+ * holding all the eigenvalues but the leading one. The Chebyshev polynomial of that interval stays within [-1, 1]
+ * on it, and grows fast beyond it, so applying it to a vector damps everything but the leading eigenvector.
+ */
+
+void estimateSpectrum(Graph *G, VerticesGroup *group, double *start, double *q, double *qPrevious, double *w,
+                      double *lowest, double *cut);
+
+double chebyshevPowerIteration(Graph *G, VerticesGroup *group, double *vector, double *vectorResult);
+
+#endif
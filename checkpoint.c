@@ -0,0 +1,219 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "checkpoint.h"
+#include "ErrorHandler.h"
+
+/* the integers before the lists: the magic, the number of vertices and the two halves of the seed */
+#define CHECKPOINT_HEADER_LENGTH 4
+
+/**
+ * Calculate the number of integers a list of groups takes in a checkpoint
+ * @param groupLst list of vertices groups
+ * @return the number of integers: the number of groups, and the depth, size and vertices of every group.
+ */
+static size_t getListLength(LinkedList *groupLst) {
+    LinkedListNode *currentNode = groupLst->first;
+    size_t length = 1;
+    int i;
+    for (i = 0; i < groupLst->length; ++i) {
+        length += 2 + ((VerticesGroup *) currentNode->pointer)->size;
+        currentNode = currentNode->next;
+    }
+    return length;
+}
+
+/**
+ * Serialize a list of groups into a buffer
+ * @param groupLst list of vertices groups
+ * @param buffer a buffer of getListLength(groupLst) integers
+ * @return the end of the serialized list in the buffer
+ */
+static int *fillListBuffer(LinkedList *groupLst, int *buffer) {
+    LinkedListNode *currentNode = groupLst->first;
+    VerticesGroup *currentGroup;
+    int i;
+    *(buffer++) = groupLst->length;
+    for (i = 0; i < groupLst->length; ++i) {
+        currentGroup = currentNode->pointer;
+        *(buffer++) = currentGroup->depth;
+        *(buffer++) = currentGroup->size;
+        memcpy(buffer, currentGroup->verticesArr, currentGroup->size * sizeof(int));
+        buffer += currentGroup->size;
+        currentNode = currentNode->next;
+    }
+    return buffer;
+}
+
+/**
+ * Write a checkpoint of a division, replacing the file at once.
+ * @param path path of the checkpoint file
+ * @param P the list of groups to divide
+ * @param O the list of final groups
+ * @param n the number of vertices of the graph
+ * @param seed the seed of the division
+ */
+void saveCheckpoint(char *path, LinkedList *P, LinkedList *O, int n, unsigned long seed) {
+    size_t length = CHECKPOINT_HEADER_LENGTH + getListLength(P) + getListLength(O);
+    char *temporaryPath = malloc(strlen(path) + 5);
+    FILE *checkpointFile;
+    int *buffer = malloc(length * sizeof(int)), *end;
+    assertMemoryAllocation(temporaryPath);
+    assertMemoryAllocation(buffer);
+
+    buffer[0] = CHECKPOINT_MAGIC;
+    buffer[1] = n;
+    buffer[2] = (int) (seed & 0xffffffffUL);
+    /* shifted twice, as a shift by the width of a 32-bit long is undefined */
+    buffer[3] = (int) ((seed >> 16) >> 16);
+    end = fillListBuffer(P, buffer + CHECKPOINT_HEADER_LENGTH);
+    fillListBuffer(O, end);
+
+    strcpy(temporaryPath, path);
+    strcat(temporaryPath, ".tmp");
+    checkpointFile = fopen(temporaryPath, "wb");
+    assertFileOpen(checkpointFile, temporaryPath);
+    assertFileWrite(fwrite(buffer, sizeof(int), length, checkpointFile), length, temporaryPath);
+    assertFileWrite(fclose(checkpointFile), 0, temporaryPath);
+    assertFileWrite(rename(temporaryPath, path), 0, path);
+    free(buffer);
+    free(temporaryPath);
+}
+
+/**
+ * Read a list of groups from a checkpoint file.
+ * @param checkpointFile the file, positioned at the list
+ * @param path path of the checkpoint file
+ * @param groupLst the list to add the groups to
+ * @param n the number of vertices of the graph
+ * @param seen n flags, the vertices read are flagged
+ */
+static void loadList(FILE *checkpointFile, char *path, LinkedList *groupLst, int n, char *seen) {
+    VerticesGroup *group;
+    int count, depth, size, i;
+    assertFileRead(fread(&count, sizeof(int), 1, checkpointFile), 1, path);
+    for (; count > 0; --count) {
+        assertFileRead(fread(&depth, sizeof(int), 1, checkpointFile), 1, path);
+        assertFileRead(fread(&size, sizeof(int), 1, checkpointFile), 1, path);
+        if (size <= 0 || size > n) {
+            throw("The checkpoint file is corrupted");
+        }
+        group = createVerticesGroup(size);
+        group->depth = depth;
+        assertFileRead(fread(group->verticesArr, sizeof(int), size, checkpointFile), size, path);
+        group->size = size;
+        /* the division expects the vertices of every group in increasing order */
+        for (i = 0; i < size; ++i) {
+            if (group->verticesArr[i] < 0 || group->verticesArr[i] >= n || seen[group->verticesArr[i]] ||
+                (i > 0 && group->verticesArr[i] <= group->verticesArr[i - 1])) {
+                throw("The checkpoint file is corrupted");
+            }
+            seen[group->verticesArr[i]] = 1;
+        }
+        insertItem(groupLst, group);
+    }
+}
+
+/**
+ * Read a checkpoint of a division, as written by saveCheckpoint.
+ * The checkpoint should be of the same graph, loaded with the same options.
+ * @param path path of the checkpoint file
+ * @param P an empty list, will be assigned the groups to divide
+ * @param O an empty list, will be assigned the final groups
+ * @param n the number of vertices of the graph
+ * @param seed will be assigned the seed of the division
+ */
+void loadCheckpoint(char *path, LinkedList *P, LinkedList *O, int n, unsigned long *seed) {
+    int header[CHECKPOINT_HEADER_LENGTH], i;
+    char *seen = calloc(n, sizeof(char));
+    FILE *checkpointFile = fopen(path, "rb");
+    assertMemoryAllocation(seen);
+    assertFileOpen(checkpointFile, path);
+    assertFileRead(fread(header, sizeof(int), CHECKPOINT_HEADER_LENGTH, checkpointFile), CHECKPOINT_HEADER_LENGTH,
+                   path);
+    if (header[0] != CHECKPOINT_MAGIC) {
+        throw("The file is not a checkpoint");
+    }
+    if (header[1] != n) {
+        throw("The checkpoint is of another graph");
+    }
+    *seed = (unsigned long) (unsigned int) header[2] | (((unsigned long) (unsigned int) header[3] << 16) << 16);
+
+    loadList(checkpointFile, path, P, n, seen);
+    loadList(checkpointFile, path, O, n, seen);
+    fclose(checkpointFile);
+    for (i = 0; i < n; ++i) {
+        if (!seen[i]) {
+            throw("The checkpoint file is corrupted");
+        }
+    }
+    free(seen);
+}
+
+/**
+ * Start taking checkpoints
+ * @param checkpointer the checkpoints state to initialize
+ * @param path path of the checkpoint file, NULL disables checkpoints
+ * @param interval seconds between two checkpoints
+ * @param now the current time, in seconds
+ */
+void initCheckpointer(Checkpointer *checkpointer, char *path, double interval, double now) {
+    checkpointer->path = path;
+    checkpointer->interval = interval;
+    checkpointer->lastTime = now;
+    checkpointer->writer = 0;
+}
+
+/**
+ * Take a checkpoint if the interval passed since the last one, and the last one is written already.
+ * The checkpoint is written by a forked child, or in place if no child can be forked.
+ * Should be called when P and O hold all the vertices, between the divisions of groups.
+ * @param checkpointer the checkpoints state
+ * @param P the list of groups to divide
+ * @param O the list of final groups
+ * @param n the number of vertices of the graph
+ * @param seed the seed of the division
+ * @param now the current time, in seconds
+ */
+void checkpointIfDue(Checkpointer *checkpointer, LinkedList *P, LinkedList *O, int n, unsigned long seed,
+                     double now) {
+    pid_t child;
+    int status;
+    if (checkpointer->path == NULL || now - checkpointer->lastTime < checkpointer->interval) {
+        return;
+    }
+    if (checkpointer->writer > 0) {
+        if (waitpid(checkpointer->writer, &status, WNOHANG) == 0) {
+            /* the last checkpoint is still written */
+            return;
+        }
+        checkpointer->writer = 0;
+    }
+
+    checkpointer->lastTime = now;
+    child = fork();
+    if (child == 0) {
+        saveCheckpoint(checkpointer->path, P, O, n, seed);
+        _exit(0);
+    } else if (child < 0) {
+        saveCheckpoint(checkpointer->path, P, O, n, seed);
+    } else {
+        checkpointer->writer = child;
+    }
+}
+
+/**
+ * Wait for the checkpoint being written, if any.
+ * @param checkpointer the checkpoints state
+ */
+void finishCheckpoints(Checkpointer *checkpointer) {
+    int status;
+    if (checkpointer->writer > 0) {
+        waitpid(checkpointer->writer, &status, 0);
+        checkpointer->writer = 0;
+    }
+}
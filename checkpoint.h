@@ -0,0 +1,46 @@
+#ifndef CLUSTER_CHECKPOINT_H
+#define CLUSTER_CHECKPOINT_H
+
+#include <sys/types.h>
+#include "LinkedList.h"
+
+/* the first integer of a checkpoint file, identifies its format */
+#define CHECKPOINT_MAGIC 0x31504b43
+/* seconds between two checkpoints, unless set otherwise */
+#define DEFAULT_CHECKPOINT_INTERVAL 60
+
+/*
+ * Checkpoints of a running division, to resume it after the process is killed.
+ * A checkpoint holds the groups left to divide (P), the final groups (O) and the seed, which is all the random
+ * state there is, as the generator of every group is keyed by the seed and by the group (see rng.h).
+ * The file is a sequence of integers: CHECKPOINT_MAGIC, the number of vertices, the low and high 32 bits of the
+ * seed, and then P and O, each as its number of groups followed by the depth, size and vertices of every group,
+ * whose vertices are in increasing order.
+ * A checkpoint is written by a forked child, from a copy-on-write snapshot of the lists, so the division goes on
+ * meanwhile. The child writes a temporary file and renames it over the checkpoint, so the checkpoint on disk is
+ * always a complete one.
+ */
+
+typedef struct _checkpointer {
+    /* the checkpoint file, NULL disables checkpoints */
+    char *path;
+    /* seconds between two checkpoints */
+    double interval;
+    /* the time of the last checkpoint */
+    double lastTime;
+    /* the child writing the last checkpoint, 0 if there is none */
+    pid_t writer;
+} Checkpointer;
+
+void saveCheckpoint(char *path, LinkedList *P, LinkedList *O, int n, unsigned long seed);
+
+void loadCheckpoint(char *path, LinkedList *P, LinkedList *O, int n, unsigned long *seed);
+
+void initCheckpointer(Checkpointer *checkpointer, char *path, double interval, double now);
+
+void checkpointIfDue(Checkpointer *checkpointer, LinkedList *P, LinkedList *O, int n, unsigned long seed,
+                     double now);
+
+void finishCheckpoints(Checkpointer *checkpointer);
+
+#endif
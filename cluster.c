@@ -1,26 +1,341 @@
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include "spmat.h"
 #include "graph.h"
 #include "LinkedList.h"
 #include "division.h"
+#include "ensemble.h"
+#include "exact.h"
+#include "manifest.h"
+#include "multiway.h"
+#include "output.h"
+#include "reorder.h"
+#include "twins.h"
 #include "ErrorHandler.h"
+#include "stats.h"
 
-int main(int argc, char **argv) {
-    LinkedList *groupsLst;
-    Graph *G;
+typedef struct _clusterOptions {
+    char *inputPath;
+    char *outputPath;
+    /* the dendrogram file, NULL if it is not written */
+    char *dendrogramPath;
+    int printStats;
+    int hasSeed;
+    int replay;
+    int sortVertices;
+    int useMmap;
+    /* the number of seeds the graph is divided by, of which the best division is kept */
+    int ensembleRuns;
+    /* whether the input is a manifest of graphs, and the output a container of their divisions */
+    int manifest;
+    /* the number of threads dividing the graphs of a manifest */
+    int workers;
+    /* whether twin vertices are collapsed before the division (see twins.h) */
+    int twins;
+    ReorderMethod reorder;
+    DivisionSettings settings;
+} ClusterOptions;
+
+/**
+ * Sets the format of the groups' edges in the sparse engine, which only one option may choose.
+ * @param options the options to fill
+ * @param storage the format chosen by the option
+ */
+static void setStorage(ClusterOptions *options, SubMatrixStorage storage) {
+    if (options->settings.storage != STORAGE_LISTS && options->settings.storage != storage) {
+        throw("Only one of the --symmetric, --compressed, --sell and --threads options can be given");
+    }
+    options->settings.storage = storage;
+}
+
+/**
+ * Parses the command line arguments.
+ * @param argc number of command line arguments
+ * @param argv command line arguments
+ * @param options the options to fill
+ */
+static void parseArguments(int argc, char **argv, ClusterOptions *options) {
+    int i, pathsCount = 0;
+    char *end;
+    options->dendrogramPath = NULL;
+    options->printStats = 0;
+    options->hasSeed = 0;
+    options->replay = 0;
+    options->sortVertices = 0;
+    options->useMmap = 0;
+    options->ensembleRuns = 1;
+    options->manifest = 0;
+    options->workers = 1;
+    options->twins = 0;
+    options->reorder = REORDER_NONE;
+    initDivisionSettings(&options->settings);
 
-    srand(time(0));
-    if (argc != 3) {
+    for (i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--stats") == 0) {
+            options->printStats = 1;
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options->settings.seed = strtoul(argv[++i], &end, 10);
+            if (*end != '\0') {
+                throw("The --seed option expects a non-negative integer");
+            }
+            options->hasSeed = 1;
+        } else if (strcmp(argv[i], "--replay") == 0) {
+            options->replay = 1;
+            options->sortVertices = 1;
+        } else if (strcmp(argv[i], "--sort") == 0) {
+            options->sortVertices = 1;
+        } else if (strcmp(argv[i], "--mmap") == 0) {
+            options->useMmap = 1;
+        } else if (strcmp(argv[i], "--no-component-split") == 0) {
+            options->settings.splitComponents = 0;
+        } else if (strcmp(argv[i], "--symmetric") == 0) {
+            setStorage(options, STORAGE_SYMMETRIC);
+        } else if (strcmp(argv[i], "--compressed") == 0) {
+            setStorage(options, STORAGE_COMPRESSED);
+        } else if (strcmp(argv[i], "--sell") == 0) {
+            setStorage(options, STORAGE_SELL);
+        } else if (strcmp(argv[i], "--bitset-density") == 0 && i + 1 < argc) {
+            options->settings.bitsetDensity = strtod(argv[++i], &end);
+            if (*end != '\0' || options->settings.bitsetDensity < 0 || options->settings.bitsetDensity > 1) {
+                throw("The --bitset-density option expects a number between 0 and 1");
+            }
+        } else if (strcmp(argv[i], "--sign-stable") == 0 && i + 1 < argc) {
+            options->settings.signStableIterations = (int) strtol(argv[++i], &end, 10);
+            if (*end != '\0' || options->settings.signStableIterations < 0) {
+                throw("The --sign-stable option expects a non-negative integer");
+            }
+        } else if (strcmp(argv[i], "--multiway") == 0 && i + 1 < argc) {
+            options->settings.splitVectors = (int) strtol(argv[++i], &end, 10);
+            if (*end != '\0' || options->settings.splitVectors < 0 ||
+                options->settings.splitVectors > MULTIWAY_MAX_VECTORS) {
+                throw("The --multiway option expects an integer between 0 and 8");
+            }
+        } else if (strcmp(argv[i], "--deadline") == 0 && i + 1 < argc) {
+            options->settings.deadline = strtod(argv[++i], &end);
+            if (*end != '\0' || options->settings.deadline <= 0) {
+                throw("The --deadline option expects a positive number of seconds");
+            }
+        } else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+            options->settings.checkpointPath = argv[++i];
+        } else if (strcmp(argv[i], "--checkpoint-interval") == 0 && i + 1 < argc) {
+            options->settings.checkpointInterval = strtod(argv[++i], &end);
+            if (*end != '\0' || options->settings.checkpointInterval < 0) {
+                throw("The --checkpoint-interval option expects a non-negative number of seconds");
+            }
+        } else if (strcmp(argv[i], "--resume") == 0 && i + 1 < argc) {
+            options->settings.resumePath = argv[++i];
+        } else if (strcmp(argv[i], "--dendrogram") == 0 && i + 1 < argc) {
+            options->dendrogramPath = argv[++i];
+        } else if (strcmp(argv[i], "--ensemble") == 0 && i + 1 < argc) {
+            options->ensembleRuns = (int) strtol(argv[++i], &end, 10);
+            if (*end != '\0' || options->ensembleRuns < 1 || options->ensembleRuns > ENSEMBLE_MAX_RUNS) {
+                throw("The --ensemble option expects an integer between 1 and 256");
+            }
+        } else if (strcmp(argv[i], "--manifest") == 0) {
+            options->manifest = 1;
+        } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            options->workers = (int) strtol(argv[++i], &end, 10);
+            if (*end != '\0' || options->workers < 1 || options->workers > MANIFEST_MAX_WORKERS) {
+                throw("The --workers option expects an integer between 1 and 256");
+            }
+        } else if (strcmp(argv[i], "--twins") == 0) {
+            options->twins = 1;
+        } else if (strcmp(argv[i], "--chebyshev") == 0) {
+            options->settings.chebyshev = 1;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            setStorage(options, STORAGE_MERGE_PATH);
+            options->settings.threads = (int) strtol(argv[++i], &end, 10);
+            if (*end != '\0' || options->settings.threads < 1) {
+                throw("The --threads option expects a positive integer");
+            }
+        } else if (strcmp(argv[i], "--no-prechecks") == 0) {
+            options->settings.preChecks = 0;
+        } else if (strcmp(argv[i], "--dense-threshold") == 0 && i + 1 < argc) {
+            options->settings.denseThreshold = (int) strtol(argv[++i], &end, 10);
+            if (*end != '\0' || options->settings.denseThreshold < 0) {
+                throw("The --dense-threshold option expects a non-negative integer");
+            }
+        } else if (strcmp(argv[i], "--exact-threshold") == 0 && i + 1 < argc) {
+            options->settings.exactThreshold = (int) strtol(argv[++i], &end, 10);
+            if (*end != '\0' || options->settings.exactThreshold < 0 ||
+                options->settings.exactThreshold > EXACT_MAX_GROUP_SIZE) {
+                throw("The --exact-threshold option expects an integer between 0 and 30");
+            }
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            options->settings.batchSize = (int) strtol(argv[++i], &end, 10);
+            if (*end != '\0' || options->settings.batchSize < 0) {
+                throw("The --batch option expects a non-negative integer");
+            }
+        } else if (strcmp(argv[i], "--reorder") == 0 && i + 1 < argc) {
+            options->reorder = parseReorderMethod(argv[++i]);
+        } else if (pathsCount == 0) {
+            options->inputPath = argv[i];
+            ++pathsCount;
+        } else if (pathsCount == 1) {
+            options->outputPath = argv[i];
+            ++pathsCount;
+        } else {
+            throw("Two command line arguments expected");
+        }
+    }
+    if (pathsCount != 2) {
         throw("Two command line arguments expected");
     }
+    if (options->manifest && (options->ensembleRuns > 1 || options->dendrogramPath != NULL || options->twins)) {
+        throw("The --manifest option does not support --ensemble, --dendrogram and --twins");
+    }
+    /* a checkpoint holds no tree, so the splits before it would be lost */
+    if (options->dendrogramPath != NULL && options->settings.resumePath != NULL) {
+        throw("The --dendrogram option does not support --resume");
+    }
+#ifndef CLUSTER_STATS
+    if (options->printStats) {
+        throw("The --stats option requires building with CLUSTER_STATS defined");
+    }
+#endif
+    if (!options->hasSeed && !options->replay) {
+        options->settings.seed = (unsigned long) time(0);
+    }
+}
 
-    G = constructGraphFromInput(argv[1]);
-    groupsLst = divisionAlgorithm(G);
+/**
+ * Reads the input graph, divides it and saves the division.
+ * @param options the options of the run
+ * @return the list of groups found by the division algorithm
+ */
+static LinkedList *clusterGraph(ClusterOptions *options) {
+    LinkedList *groupsLst;
+    TwinClasses *classes = NULL;
+    Graph *G, *reduced;
+    int n;
 
-    saveOutputToFile(groupsLst, argv[2]);
-    deepFreeGroupList(groupsLst);
+    STATS_START(STATS_PHASE_LOAD);
+    G = constructGraphFromInput(options->inputPath);
+    n = G->n;
+    if (options->twins) {
+        classes = findTwinClasses(G);
+        if (classes != NULL) {
+            reduced = compressTwins(G, classes);
+            destroyGraph(G);
+            G = reduced;
+            restrictSettingsToWeights(&options->settings);
+        }
+    }
+    reorderGraph(G, options->reorder);
+    STATS_STOP(STATS_PHASE_LOAD, -1);
+    if (options->dendrogramPath != NULL) {
+        options->settings.dendrogram = createDendrogram();
+    }
+    if (options->ensembleRuns > 1) {
+        groupsLst = ensembleDivisionAlgorithm(G, &options->settings, options->ensembleRuns);
+    } else {
+        groupsLst = divisionAlgorithm(G, &options->settings);
+    }
+    if (G->originalIndices != NULL) {
+        restoreOriginalIndices(groupsLst, G->originalIndices);
+    }
+    if (classes != NULL) {
+        expandTwins(groupsLst, classes);
+        freeTwinClasses(classes);
+    }
+    if (options->replay) {
+        sortGroupList(groupsLst);
+    }
+
+    STATS_START(STATS_PHASE_OUTPUT);
+    saveOutputToFile(groupsLst, options->outputPath, options->sortVertices, options->useMmap);
+    if (options->settings.dendrogram != NULL) {
+        saveDendrogramToFile(options->settings.dendrogram, groupsLst, n, options->dendrogramPath);
+        freeDendrogram(options->settings.dendrogram);
+    }
+    STATS_STOP(STATS_PHASE_OUTPUT, -1);
     destroyGraph(G);
+    return groupsLst;
+}
+
+/**
+ * Runs the whole clustering process: reads the input graph, divides it and saves the division.
+ * Besides the input and output paths, the following options are accepted:
+ * --stats   print a JSON summary of the per-phase timers and counters (requires a CLUSTER_STATS build).
+ * --seed N  seed the random start vectors, so the division can be reproduced. Otherwise the time is used.
+ * --replay  deterministic-replay mode: the seed defaults to 0, and the groups and their vertices are written
+ *           in a canonical order, so the output file depends only on the input and the seed.
+ * --sort    write the vertices of every group in increasing order.
+ * --mmap    write the output file through a memory mapping.
+ * --reorder METHOD  relabel the vertices after loading, for cache locality ("degree" or "rcm").
+ *           The output is mapped back to the input indices.
+ * --dense-threshold N  divide groups of up to N vertices with the dense engine (0 disables it).
+ * --exact-threshold N  divide groups of up to N vertices optimally, by exhaustive search (0 disables it).
+ * --batch N  solve the eigenproblems of up to N groups of the sparse engine together (0 or 1 disables it).
+ *           Only groups above the dense threshold are batched, lower it to batch smaller groups.
+ * --no-component-split  start the division from the whole graph, instead of from its connected components.
+ * --symmetric  keep only the upper triangle of the groups' edges in the sparse engine, halving their memory.
+ *           The graph's own edges stay in linked lists, so the peak memory falls by about a third when the first
+ *           group is a large connected component, and not at all when the groups are left to the dense engine.
+ * --compressed  keep the groups' edges of the sparse engine as varint-encoded gaps, about a byte or two per edge.
+ *           As with --symmetric, the graph's own edges stay in linked lists, which then hold most of the peak memory.
+ * --sell    keep the groups' edges of the sparse engine in the sliced ELLPACK format, for SIMD multiplication.
+ * --bitset-density X  keep the edges of groups at least this dense (0.05 by default) in a bit matrix,
+ *           whose products with +1/-1 vectors are counted a word at a time (0 disables it).
+ * --sign-stable N  stop the power iteration once the signs of its vector are unchanged for N iterations and the
+ *           Rayleigh quotient is stable, leaving the polish to the refinement (0, the default, waits for convergence).
+ * --chebyshev  find the leading eigenvectors by a Chebyshev-filtered power iteration, over a spectrum estimated by
+ *           a few Lanczos steps, instead of shifting by the 1-norm.
+ * --multiway P  divide every group of the sparse engine at once into up to 2P parts, by its P leading eigenvectors
+ *           (at most 8, 0 or 1 bisects).
+ * --threads N  multiply the groups' edges of the sparse engine by N threads, splitting the non-zero values evenly
+ *           (merge-path), so the rows of hub vertices are shared between the threads. The products, and so the
+ *           output, are the same for every N. Merge-path is a format of its own, so --symmetric, --compressed and
+ *           --sell are not supported with it.
+ * --deadline SECONDS  stop dividing after this many seconds of the division, dividing the largest groups first.
+ *           The groups not divided by then are written as they are, and counted in the stats.
+ * --checkpoint PATH  save the groups left to divide and the final groups to PATH periodically, from a forked child.
+ * --checkpoint-interval SECONDS  the time between two checkpoints (60 by default).
+ * --resume PATH  continue the division from a checkpoint, taken with the same input and options (and its seed).
+ * --dendrogram PATH  also write the tree of the accepted splits to PATH, with the modularity gain of every split, so
+ *           coarser divisions can be cut from it without dividing again (see dendrogram.h for the format).
+ *           Not supported with --resume.
+ * --ensemble N  divide the graph N times in threads, by the seeds seed, seed+1, ..., seed+N-1, sharing the loaded
+ *           graph, and write the division of the highest modularity (runs one after another in a CLUSTER_STATS build).
+ * --manifest  the input file is a manifest, listing the input files of many graphs (a path per line), and the output
+ *           file is a container of all their divisions, with an index (see manifest.h).
+ * --workers N  divide the graphs of a manifest by N threads (1 by default).
+ * --twins  collapse the vertices of identical neighbor lists into weighted super-vertices before the division, and
+ *           expand them back in the output. The modularity is computed exactly, and twins are never separated.
+ *           The formats and the checks which assume unweighted edges are turned off (--compressed, the bit matrix,
+ *           the prechecks and --multiway).
+ * --no-prechecks  run the solve also for groups which are cheaply proven indivisible (cliques, stars, pairs).
+ * @param argc number of command line arguments
+ * @param argv command line arguments
+ * @return the list of groups found by the division algorithm
+ */
+LinkedList *cluster(int argc, char **argv) {
+    LinkedList *groupsLst;
+    ClusterOptions options;
 
+    parseArguments(argc, argv, &options);
+
+    STATS_RESET();
+    if (options.manifest) {
+        divideManifest(options.inputPath, options.outputPath, &options.settings, options.reorder, options.replay,
+                       options.sortVertices, options.workers);
+        groupsLst = createLinkedList();
+    } else {
+        groupsLst = clusterGraph(&options);
+    }
+
+#ifdef CLUSTER_STATS
+    if (options.printStats) {
+        statsPrintJson(stdout);
+    }
+#endif
+    return groupsLst;
+}
+
+#ifndef CLUSTER_NO_MAIN
+int main(int argc, char **argv) {
+    deepFreeGroupList(cluster(argc, argv));
     return 0;
 }
+#endif
@@ -0,0 +1,142 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "dendrogram.h"
+#include "ErrorHandler.h"
+
+/* nodes allocated by an empty dendrogram */
+#define DENDROGRAM_INITIAL_CAPACITY 64
+
+/**
+ * Create an empty dendrogram
+ * @return the dendrogram
+ */
+Dendrogram *createDendrogram() {
+    Dendrogram *dendrogram = malloc(sizeof(Dendrogram));
+    assertMemoryAllocation(dendrogram);
+    dendrogram->nodesCount = 0;
+    dendrogram->capacity = DENDROGRAM_INITIAL_CAPACITY;
+    dendrogram->parents = malloc(dendrogram->capacity * sizeof(int));
+    assertMemoryAllocation(dendrogram->parents);
+    dendrogram->gains = malloc(dendrogram->capacity * sizeof(double));
+    assertMemoryAllocation(dendrogram->gains);
+    return dendrogram;
+}
+
+/**
+ * Free memory allocated for a dendrogram
+ * @param dendrogram
+ */
+void freeDendrogram(Dendrogram *dendrogram) {
+    free(dendrogram->parents);
+    free(dendrogram->gains);
+    free(dendrogram);
+}
+
+/**
+ * Add a node to a dendrogram, and assign it to a group
+ * @param dendrogram the dendrogram
+ * @param group the group of the node
+ * @param parent the parent node, -1 for a root
+ */
+static void addNode(Dendrogram *dendrogram, VerticesGroup *group, int parent) {
+    if (dendrogram->nodesCount == dendrogram->capacity) {
+        dendrogram->capacity *= 2;
+        dendrogram->parents = realloc(dendrogram->parents, dendrogram->capacity * sizeof(int));
+        assertMemoryAllocation(dendrogram->parents);
+        dendrogram->gains = realloc(dendrogram->gains, dendrogram->capacity * sizeof(double));
+        assertMemoryAllocation(dendrogram->gains);
+    }
+    dendrogram->parents[dendrogram->nodesCount] = parent;
+    dendrogram->gains[dendrogram->nodesCount] = 0;
+    group->treeNode = dendrogram->nodesCount++;
+}
+
+/**
+ * Add the groups of a list which have no node yet as roots
+ * @param dendrogram the dendrogram
+ * @param groupLst list of vertices groups
+ */
+void addDendrogramRoots(Dendrogram *dendrogram, LinkedList *groupLst) {
+    LinkedListNode *currentNode = groupLst->first;
+    int i;
+    for (i = 0; i < groupLst->length; ++i) {
+        if (((VerticesGroup *) currentNode->pointer)->treeNode == -1) {
+            addNode(dendrogram, currentNode->pointer, -1);
+        }
+        currentNode = currentNode->next;
+    }
+}
+
+/**
+ * Sum the edges and the degrees of a group: the sum of B over the pairs of its vertices is edges - degrees^2 / M.
+ * @param G graph object
+ * @param group vertices group
+ * @param innerDegrees an allocated array of capacity group->size
+ * @return the sum of B over the ordered pairs of the group's vertices
+ */
+static double sumGroupModularity(Graph *G, VerticesGroup *group, int *innerDegrees) {
+    double edges = 0, degrees = 0;
+    int i;
+    countInnerDegrees(G, group, innerDegrees);
+    for (i = 0; i < group->size; ++i) {
+        edges += innerDegrees[i];
+        degrees += G->degrees[group->verticesArr[i]];
+    }
+    return edges - degrees * degrees / G->degreeSum;
+}
+
+/**
+ * Record an accepted split: the parts become children of the group, and the group's node is assigned the gain.
+ * The gain is calculated from the parts themselves, so every engine is recorded alike.
+ * @param dendrogram the dendrogram
+ * @param G graph object
+ * @param group the split group, should have a node already
+ * @param parts the parts of the group
+ * @param partsCount the number of parts
+ */
+void recordSplit(Dendrogram *dendrogram, Graph *G, VerticesGroup *group, VerticesGroup **parts, int partsCount) {
+    int i, *innerDegrees = malloc(group->size * sizeof(int));
+    double gain;
+    assertMemoryAllocation(innerDegrees);
+    gain = -sumGroupModularity(G, group, innerDegrees);
+    for (i = 0; i < partsCount; ++i) {
+        gain += sumGroupModularity(G, parts[i], innerDegrees);
+        addNode(dendrogram, parts[i], group->treeNode);
+    }
+    dendrogram->gains[group->treeNode] = gain / G->degreeSum;
+    free(innerDegrees);
+}
+
+/**
+ * Save a dendrogram to a file, in the format described in dendrogram.h
+ * @param dendrogram the dendrogram
+ * @param groupLst the final groups of the division (the leaves)
+ * @param n the number of vertices
+ * @param path path of the dendrogram file
+ */
+void saveDendrogramToFile(Dendrogram *dendrogram, LinkedList *groupLst, int n, char *path) {
+    LinkedListNode *currentNode = groupLst->first;
+    VerticesGroup *currentGroup;
+    FILE *dendrogramFile;
+    int i, j, *leaves = malloc(n * sizeof(int));
+    assertMemoryAllocation(leaves);
+    for (i = 0; i < groupLst->length; ++i) {
+        currentGroup = currentNode->pointer;
+        for (j = 0; j < currentGroup->size; ++j) {
+            leaves[currentGroup->verticesArr[j]] = currentGroup->treeNode;
+        }
+        currentNode = currentNode->next;
+    }
+
+    dendrogramFile = fopen(path, "wb");
+    assertFileOpen(dendrogramFile, path);
+    assertFileWrite(fwrite(&n, sizeof(int), 1, dendrogramFile), 1, path);
+    assertFileWrite(fwrite(&dendrogram->nodesCount, sizeof(int), 1, dendrogramFile), 1, path);
+    assertFileWrite(fwrite(dendrogram->parents, sizeof(int), dendrogram->nodesCount, dendrogramFile),
+                    dendrogram->nodesCount, path);
+    assertFileWrite(fwrite(dendrogram->gains, sizeof(double), dendrogram->nodesCount, dendrogramFile),
+                    dendrogram->nodesCount, path);
+    assertFileWrite(fwrite(leaves, sizeof(int), n, dendrogramFile), n, path);
+    assertFileWrite(fclose(dendrogramFile), 0, path);
+    free(leaves);
+}
@@ -0,0 +1,37 @@
+#ifndef CLUSTER_DENDROGRAM_H
+#define CLUSTER_DENDROGRAM_H
+
+#include "graph.h"
+#include "VerticesGroup.h"
+#include "LinkedList.h"
+
+/*
+ * The tree of the accepted splits of a division.
+ * Every group the division handles is a node: the initial groups are the roots, and the parts of every accepted
+ * split are the children of the split group. Nodes are numbered in their order of creation, so a parent always
+ * comes before its children, and every node holds the modularity gain (delta Q) of its own split.
+ * The dendrogram file is, in this order: the number of vertices n (int), the number of nodes (int), the parent of
+ * every node (ints, -1 for the roots), the gain of every node (doubles, 0 for the leaves), and the leaf of every
+ * vertex (n ints). A coarser division is then cut from it in linear time, at any depth or gain threshold.
+ */
+
+typedef struct _dendrogram {
+    int nodesCount;
+    int capacity;
+    /* the parent of every node, -1 for the roots */
+    int *parents;
+    /* the modularity gain of the split of every node, 0 for the leaves */
+    double *gains;
+} Dendrogram;
+
+Dendrogram *createDendrogram();
+
+void freeDendrogram(Dendrogram *dendrogram);
+
+void addDendrogramRoots(Dendrogram *dendrogram, LinkedList *groupLst);
+
+void recordSplit(Dendrogram *dendrogram, Graph *G, VerticesGroup *group, VerticesGroup **parts, int partsCount);
+
+void saveDendrogramToFile(Dendrogram *dendrogram, LinkedList *groupLst, int n, char *path);
+
+#endif
@@ -0,0 +1,483 @@
+#include <stdlib.h>
+#include <math.h>
+#include "dense.h"
+#include "division.h"
+#include "defs.h"
+#include "ErrorHandler.h"
+#include "stats.h"
+
+/* QL iterations allowed per eigenvalue before the solver gives up */
+#define DENSE_MAX_QL_ITERATIONS 60
+
+/**
+ * Compute sqrt(a^2 + b^2) without overflow or destructive underflow.
+ */
+static double hypotenuse(double a, double b) {
+    double r;
+    if (fabs(a) > fabs(b)) {
+        r = b / a;
+        return fabs(a) * sqrt(1 + r * r);
+    }
+    if (b != 0) {
+        r = a / b;
+        return fabs(b) * sqrt(1 + r * r);
+    }
+    return 0;
+}
+
+/**
+ * Build the dense modularity matrix of a group, B[g][i][j] = A[i][j] - k_i * k_j / M.
+ * The row sums f_i of B[g] are returned as well, so that B_hat[g] = B[g] - diag(f).
+ * @param G graph object
+ * @param group vertices group, with vertices in increasing order
+ * @param rowSums an allocated array of group->size items, will be assigned the row sums
+ * @return a new group->size X group->size row-major matrix, should be freed by the caller
+ */
+double *buildDenseModularityMatrix(Graph *G, VerticesGroup *group, double *rowSums) {
+    nodeRef *rows = (nodeRef *) G->adjMat->private;
+    nodeRef spmNode;
+    int n = group->size, i, j;
+    int *vertices = group->verticesArr;
+    double *B = malloc((size_t) n * n * sizeof(double));
+    double *row, degree, sum;
+    assertMemoryAllocation(B);
+
+    for (i = 0; i < n; i++) {
+        row = B + (size_t) i * n;
+        degree = G->degrees[vertices[i]];
+        for (j = 0; j < n; j++) {
+            row[j] = -degree * G->degrees[vertices[j]] / G->degreeSum;
+        }
+        /* both the adjacency row and the group are sorted, so they are merged */
+        spmNode = rows[vertices[i]];
+        j = 0;
+        while (spmNode != NULL && j < n) {
+            if (spmNode->colind < vertices[j]) {
+                spmNode = spmNode->next;
+            } else if (spmNode->colind > vertices[j]) {
+                j++;
+            } else {
+                row[j] += spmNode->value;
+                spmNode = spmNode->next;
+                j++;
+            }
+        }
+        sum = 0;
+        for (j = 0; j < n; j++) {
+            sum += row[j];
+        }
+        rowSums[i] = sum;
+    }
+    return B;
+}
+
+/**
+ * Reduce a symmetric matrix to tridiagonal form by Householder reflections (EISPACK tred2).
+ * @param V the n X n matrix, is replaced by the accumulated orthogonal transformation
+ * @param n the dimension
+ * @param d will be assigned the diagonal of the tridiagonal matrix
+ * @param e will be assigned the sub diagonal of the tridiagonal matrix, in e[1..n-1]
+ */
+static void tridiagonalize(double *V, int n, double *d, double *e) {
+    int i, j, k;
+    double scale, f, g, h, hh;
+
+    for (j = 0; j < n; j++) {
+        d[j] = V[(n - 1) * n + j];
+    }
+    for (i = n - 1; i > 0; i--) {
+        scale = 0;
+        h = 0;
+        for (k = 0; k < i; k++) {
+            scale += fabs(d[k]);
+        }
+        if (scale == 0) {
+            e[i] = d[i - 1];
+            for (j = 0; j < i; j++) {
+                d[j] = V[(i - 1) * n + j];
+                V[i * n + j] = 0;
+                V[j * n + i] = 0;
+            }
+        } else {
+            /* generate the Householder vector */
+            for (k = 0; k < i; k++) {
+                d[k] /= scale;
+                h += d[k] * d[k];
+            }
+            f = d[i - 1];
+            g = sqrt(h);
+            if (f > 0) {
+                g = -g;
+            }
+            e[i] = scale * g;
+            h = h - f * g;
+            d[i - 1] = f - g;
+            for (j = 0; j < i; j++) {
+                e[j] = 0;
+            }
+            /* apply the similarity transformation to the remaining columns */
+            for (j = 0; j < i; j++) {
+                f = d[j];
+                V[j * n + i] = f;
+                g = e[j] + V[j * n + j] * f;
+                for (k = j + 1; k <= i - 1; k++) {
+                    g += V[k * n + j] * d[k];
+                    e[k] += V[k * n + j] * f;
+                }
+                e[j] = g;
+            }
+            f = 0;
+            for (j = 0; j < i; j++) {
+                e[j] /= h;
+                f += e[j] * d[j];
+            }
+            hh = f / (h + h);
+            for (j = 0; j < i; j++) {
+                e[j] -= hh * d[j];
+            }
+            for (j = 0; j < i; j++) {
+                f = d[j];
+                g = e[j];
+                for (k = j; k <= i - 1; k++) {
+                    V[k * n + j] -= (f * e[k] + g * d[k]);
+                }
+                d[j] = V[(i - 1) * n + j];
+                V[i * n + j] = 0;
+            }
+        }
+        d[i] = h;
+    }
+
+    /* accumulate the transformations */
+    for (i = 0; i < n - 1; i++) {
+        V[(n - 1) * n + i] = V[i * n + i];
+        V[i * n + i] = 1;
+        h = d[i + 1];
+        if (h != 0) {
+            for (k = 0; k <= i; k++) {
+                d[k] = V[k * n + i + 1] / h;
+            }
+            for (j = 0; j <= i; j++) {
+                g = 0;
+                for (k = 0; k <= i; k++) {
+                    g += V[k * n + i + 1] * V[k * n + j];
+                }
+                for (k = 0; k <= i; k++) {
+                    V[k * n + j] -= g * d[k];
+                }
+            }
+        }
+        for (k = 0; k <= i; k++) {
+            V[k * n + i + 1] = 0;
+        }
+    }
+    for (j = 0; j < n; j++) {
+        d[j] = V[(n - 1) * n + j];
+        V[(n - 1) * n + j] = 0;
+    }
+    V[(n - 1) * n + n - 1] = 1;
+    e[0] = 0;
+}
+
+/**
+ * Diagonalize a symmetric tridiagonal matrix by QL iterations with implicit shifts (EISPACK tql2).
+ * @param V the transformation returned by tridiagonalize, is replaced by the eigenvectors (as columns)
+ * @param n the dimension
+ * @param d the diagonal, is replaced by the eigenvalues
+ * @param e the sub diagonal, is destroyed
+ */
+static void diagonalizeTridiagonal(double *V, int n, double *d, double *e) {
+    int i, k, l, m, iteration;
+    double f = 0, tst1 = 0, eps = pow(2.0, -52.0);
+    double g, p, r, dl1, h, c, c2, c3, el1, s, s2;
+
+    for (i = 1; i < n; i++) {
+        e[i - 1] = e[i];
+    }
+    e[n - 1] = 0;
+
+    for (l = 0; l < n; l++) {
+        /* find a small sub diagonal element */
+        if (fabs(d[l]) + fabs(e[l]) > tst1) {
+            tst1 = fabs(d[l]) + fabs(e[l]);
+        }
+        m = l;
+        while (m < n - 1 && fabs(e[m]) > eps * tst1) {
+            m++;
+        }
+
+        /* if m == l, d[l] is an eigenvalue, otherwise iterate */
+        if (m > l) {
+            iteration = 0;
+            do {
+                assertBooleanStatementIsTrue(++iteration <= DENSE_MAX_QL_ITERATIONS);
+                /* compute the implicit shift */
+                g = d[l];
+                p = (d[l + 1] - g) / (2 * e[l]);
+                r = hypotenuse(p, 1);
+                if (p < 0) {
+                    r = -r;
+                }
+                d[l] = e[l] / (p + r);
+                d[l + 1] = e[l] * (p + r);
+                dl1 = d[l + 1];
+                h = g - d[l];
+                for (i = l + 2; i < n; i++) {
+                    d[i] -= h;
+                }
+                f += h;
+
+                /* implicit QL transformation */
+                p = d[m];
+                c = 1;
+                c2 = c;
+                c3 = c;
+                el1 = e[l + 1];
+                s = 0;
+                s2 = 0;
+                for (i = m - 1; i >= l; i--) {
+                    c3 = c2;
+                    c2 = c;
+                    s2 = s;
+                    g = c * e[i];
+                    h = c * p;
+                    r = hypotenuse(p, e[i]);
+                    e[i + 1] = s * r;
+                    s = e[i] / r;
+                    c = p / r;
+                    p = c * d[i] - s * g;
+                    d[i + 1] = h + s * (c * g + s * d[i]);
+                    /* accumulate the transformation */
+                    for (k = 0; k < n; k++) {
+                        h = V[k * n + i + 1];
+                        V[k * n + i + 1] = s * V[k * n + i] + c * h;
+                        V[k * n + i] = c * V[k * n + i] - s * h;
+                    }
+                }
+                p = -s * s2 * c3 * el1 * e[l] / dl1;
+                e[l] = s * p;
+                d[l] = c * p;
+            } while (fabs(e[l]) > eps * tst1);
+        }
+        d[l] += f;
+        e[l] = 0;
+    }
+}
+
+/**
+ * Find all the eigenpairs of a dense symmetric matrix.
+ * @param matrix a n X n row-major symmetric matrix, is replaced by the unit eigenvectors (as columns)
+ * @param n the dimension
+ * @param eigenvalues an allocated array of n items, will be assigned the eigenvalues (in no particular order)
+ */
+void denseEigenpairs(double *matrix, int n, double *eigenvalues) {
+    double *e = malloc(n * sizeof(double));
+    assertMemoryAllocation(e);
+    tridiagonalize(matrix, n, eigenvalues, e);
+    diagonalizeTridiagonal(matrix, n, eigenvalues, e);
+    free(e);
+}
+
+/**
+ * Find the eigenvalues of a symmetric tridiagonal matrix.
+ * @param diagonal the n diagonal values, is replaced by the eigenvalues (in no particular order)
+ * @param offDiagonal the n-1 values next to the diagonal
+ * @param n the dimension
+ */
+void tridiagonalEigenvalues(double *diagonal, const double *offDiagonal, int n) {
+    int i;
+    double *V = calloc(n * n, sizeof(double));
+    double *e = malloc(n * sizeof(double));
+    assertMemoryAllocation(V);
+    assertMemoryAllocation(e);
+    e[0] = 0;
+    for (i = 0; i < n; i++) {
+        V[i * n + i] = 1;
+        if (i > 0) {
+            e[i] = offDiagonal[i - 1];
+        }
+    }
+    diagonalizeTridiagonal(V, n, diagonal, e);
+    free(e);
+    free(V);
+}
+
+/**
+ * Find the leading (algebraically largest) eigenpair of a dense symmetric matrix.
+ * @param matrix a n X n row-major symmetric matrix, is destroyed
+ * @param n the dimension
+ * @param eigenvector an allocated array of n items, will be assigned the unit eigenvector
+ * @return the leading eigenvalue
+ */
+double denseLeadingEigenpair(double *matrix, int n, double *eigenvector) {
+    double *d = malloc(n * sizeof(double));
+    double *e = malloc(n * sizeof(double));
+    double lambda;
+    int i, leading = 0;
+    assertMemoryAllocation(d);
+    assertMemoryAllocation(e);
+
+    tridiagonalize(matrix, n, d, e);
+    diagonalizeTridiagonal(matrix, n, d, e);
+    for (i = 1; i < n; i++) {
+        if (d[i] > d[leading]) {
+            leading = i;
+        }
+    }
+    for (i = 0; i < n; i++) {
+        eigenvector[i] = matrix[i * n + leading];
+    }
+    lambda = d[leading];
+
+    free(e);
+    free(d);
+    return lambda;
+}
+
+/**
+ * Maximize modularity by moving nodes between the sub groups, like maximizeModularity,
+ * reading the modularity matrix from its dense form.
+ * @param G graph object
+ * @param group a group of vertices
+ * @param B the dense modularity matrix of the group, as built by buildDenseModularityMatrix
+ * @param rowSums the row sums of B
+ * @param s a +1/-1 division vector, will be assigned the maximum split
+ * @param numberOfPositiveVertices will be assigned the number of vertices in sub group A after the division
+ * @return the modularity delta of the division
+ */
+double denseMaximizeModularity(Graph *G, VerticesGroup *group, double *B, double *rowSums, double *s,
+                               unsigned int *numberOfPositiveVertices) {
+    int n = group->size;
+    double bestImprovement, improve, maxScore = 0, sum, modularity = 0;
+    int iteration, i, j, maxNode = 0, prevMaxNode = 0, bestIteration, isMaxSet, isSetBestImprovement;
+    double *row, *score = malloc(n * sizeof(double));
+    char *hasMoved = calloc(n, sizeof(char));
+    int *indices = malloc(n * sizeof(int));
+    assertMemoryAllocation(score);
+    assertMemoryAllocation(hasMoved);
+    assertMemoryAllocation(indices);
+
+    do {
+        STATS_COUNT(STATS_COUNTER_REFINEMENT_PASSES, group->depth, 1);
+        bestImprovement = 0;
+        improve = 0;
+        bestIteration = -1;
+        isSetBestImprovement = 0;
+        for (iteration = 0; iteration < n; iteration++) {
+            isMaxSet = 0;
+            for (i = 0; i < n; i++) {
+                if (hasMoved[i])
+                    continue;
+                row = B + (size_t) i * n;
+                if (iteration == 0) {
+                    sum = 0;
+                    for (j = 0; j < n; j++) {
+                        sum += row[j] * s[j];
+                    }
+                    score[i] = -2 * (s[i] * sum + pow(G->degrees[group->verticesArr[i]], 2) / G->degreeSum);
+                } else {
+                    score[i] -= 4 * s[i] * s[prevMaxNode] * row[prevMaxNode];
+                }
+                if (!isMaxSet || score[i] > maxScore) {
+                    maxScore = score[i];
+                    maxNode = i;
+                    isMaxSet = 1;
+                }
+            }
+            s[maxNode] = -s[maxNode];
+            prevMaxNode = maxNode;
+            hasMoved[maxNode] = 1;
+            indices[iteration] = maxNode;
+
+            improve += maxScore;
+            if (!isSetBestImprovement || improve > bestImprovement) {
+                bestIteration = iteration;
+                bestImprovement = improve;
+                isSetBestImprovement = 1;
+            }
+        }
+
+        *numberOfPositiveVertices = 0;
+        for (iteration = 0; iteration < n; iteration++) {
+            i = indices[iteration];
+            hasMoved[iteration] = 0;
+            if (iteration > bestIteration) {
+                s[i] = -s[i];
+            }
+            *numberOfPositiveVertices += (s[i] == 1);
+        }
+    } while (bestIteration != n - 1 && IS_POSITIVE(bestImprovement));
+
+    /* the modularity delta is 0.5 * s^T * B_hat[g] * s, where B_hat[g] = B[g] - diag(f) */
+    for (i = 0; i < n; i++) {
+        row = B + (size_t) i * n;
+        sum = 0;
+        for (j = 0; j < n; j++) {
+            sum += row[j] * s[j];
+        }
+        modularity += s[i] * sum - rowSums[i];
+    }
+
+    free(indices);
+    free(hasMoved);
+    free(score);
+    return 0.5 * modularity;
+}
+
+/**
+ * Divide a small group into two, using the dense engine.
+ * This is the dense counterpart of divisionAlgorithm2 (the random start vector is not needed).
+ * @param G graph object
+ * @param group vertices group
+ * @param s an allocated array the capacity of the graph's vertices, used for storing an eigenvector
+ * @param newGroupA the first divided group will be assigned to this parameter (or left as NULL)
+ * @param newGroupB the second divided group will be assigned to this parameter (or left as NULL)
+ */
+void denseDivisionAlgorithm(Graph *G, VerticesGroup *group, double *s, VerticesGroup **newGroupA,
+                            VerticesGroup **newGroupB) {
+    int n = group->size, i;
+    double *B, *BHat, *rowSums, lambda, modularity;
+    unsigned int numberOfPositiveVertices = 0;
+
+    STATS_START(STATS_PHASE_SUBMATRIX);
+    rowSums = malloc(n * sizeof(double));
+    assertMemoryAllocation(rowSums);
+    B = buildDenseModularityMatrix(G, group, rowSums);
+    BHat = malloc((size_t) n * n * sizeof(double));
+    assertMemoryAllocation(BHat);
+    for (i = 0; i < n * n; i++) {
+        BHat[i] = B[i];
+    }
+    for (i = 0; i < n; i++) {
+        BHat[(size_t) i * n + i] -= rowSums[i];
+    }
+    STATS_STOP(STATS_PHASE_SUBMATRIX, group->depth);
+
+    STATS_START(STATS_PHASE_EIGEN);
+    lambda = denseLeadingEigenpair(BHat, n, s);
+    STATS_STOP(STATS_PHASE_EIGEN, group->depth);
+    free(BHat);
+
+    if (IS_POSITIVE(lambda)) {
+        for (i = 0; i < n; i++) {
+            s[i] = IS_POSITIVE(s[i]) ? 1 : -1;
+        }
+
+        STATS_START(STATS_PHASE_REFINEMENT);
+        modularity = denseMaximizeModularity(G, group, B, rowSums, s, &numberOfPositiveVertices);
+        STATS_STOP(STATS_PHASE_REFINEMENT, group->depth);
+
+        if (IS_POSITIVE(modularity)) {
+            STATS_COUNT(STATS_COUNTER_SPLITS_ACCEPTED, group->depth, 1);
+            STATS_COUNT(STATS_COUNTER_DENSE_SPLITS, group->depth, 1);
+            divideGroupByEigenvector(group, s, newGroupA, newGroupB, numberOfPositiveVertices);
+        } else {
+            STATS_COUNT(STATS_COUNTER_REJECTED_MODULARITY, group->depth, 1);
+        }
+    } else {
+        STATS_COUNT(STATS_COUNTER_REJECTED_EIGENVALUE, group->depth, 1);
+    }
+
+    free(B);
+    free(rowSums);
+}
@@ -0,0 +1,28 @@
+#ifndef CLUSTER_DENSE_H
+#define CLUSTER_DENSE_H
+
+#include "graph.h"
+#include "VerticesGroup.h"
+
+/*
+ * Dense engine for small groups.
+ * The modularity matrix of the group is built as a dense, row-major array which stays in cache,
+ * its leading eigenpair is found directly (Householder tridiagonalization followed by QL iterations),
+ * and the refinement runs on the dense matrix, instead of on the linked-list sub matrix.
+ */
+
+double *buildDenseModularityMatrix(Graph *G, VerticesGroup *group, double *rowSums);
+
+double denseLeadingEigenpair(double *matrix, int n, double *eigenvector);
+
+void denseEigenpairs(double *matrix, int n, double *eigenvalues);
+
+void tridiagonalEigenvalues(double *diagonal, const double *offDiagonal, int n);
+
+double denseMaximizeModularity(Graph *G, VerticesGroup *group, double *B, double *rowSums, double *s,
+                               unsigned int *numberOfPositiveVertices);
+
+void denseDivisionAlgorithm(Graph *G, VerticesGroup *group, double *s, VerticesGroup **newGroupA,
+                            VerticesGroup **newGroupB);
+
+#endif
@@ -1,20 +1,56 @@
 
+#define _POSIX_C_SOURCE 199309L
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
+#include <time.h>
 #include "division.h"
+#include "dense.h"
+#include "exact.h"
+#include "batch.h"
+#include "chebyshev.h"
+#include "checkpoint.h"
+#include "indivisible.h"
+#include "multiway.h"
 #include "defs.h"
 #include "ErrorHandler.h"
+#include "stats.h"
+
+/**
+ * Set the default division settings
+ * @param settings the settings to initialize
+ */
+void initDivisionSettings(DivisionSettings *settings) {
+    settings->seed = 0;
+    settings->splitComponents = 1;
+    settings->denseThreshold = DEFAULT_DENSE_THRESHOLD;
+    settings->exactThreshold = DEFAULT_EXACT_THRESHOLD;
+    settings->batchSize = 0;
+    settings->preChecks = 1;
+    settings->storage = STORAGE_LISTS;
+    settings->threads = 1;
+    settings->bitsetDensity = DEFAULT_BITSET_DENSITY;
+    settings->signStableIterations = 0;
+    settings->chebyshev = 0;
+    settings->splitVectors = 0;
+    settings->deadline = 0;
+    settings->checkpointPath = NULL;
+    settings->checkpointInterval = DEFAULT_CHECKPOINT_INTERVAL;
+    settings->resumePath = NULL;
+    settings->dendrogram = NULL;
+}
 
 /**
- * Generate a random vector
+ * Generate a random vector with positive entries
  * @param vector an allocated array of capacity n for the vector
  * @param n the capacity of the vector
+ * @param rng the random generator to draw from
  */
-void randVector(double *vector, int n) {
+void randVector(double *vector, int n, Rng *rng) {
     int i;
     for (i = 0; i < n; i++) {
-        *(vector + i) = rand();
+        *(vector + i) = nextRandom(rng) + 1.0;
     }
 }
 
@@ -35,6 +71,10 @@ divideGroupByEigenvector(VerticesGroup *group, double *s, VerticesGroup **splitG
         *splitGroupA = createVerticesGroup(numberOfPositiveVertices);
     if (group->size - numberOfPositiveVertices > 0)
         *splitGroupB = createVerticesGroup(group->size - numberOfPositiveVertices);
+    if (*splitGroupA != NULL)
+        (*splitGroupA)->depth = group->depth + 1;
+    if (*splitGroupB != NULL)
+        (*splitGroupB)->depth = group->depth + 1;
     for (i = 0; i < group->size; ++i) {
         if (!IS_POSITIVE(s[i]))
             addVertexToGroup(*splitGroupB, group->verticesArr[i]);
@@ -43,31 +83,6 @@ divideGroupByEigenvector(VerticesGroup *group, double *s, VerticesGroup **splitG
     }
 }
 
-/**
- * Find increasing index elements in row of sparse matrix
- * @param spmNode node of sparse matrix
- * @param col column of sparse matrix
- * @return value
- */
-double loopFindSpmValue(nodeRef spmNode, int col) {
-    double spmValue;
-    int con = 1;
-    /* this while loop essentially finds the (i,j) value
-     * in the sparse adjacency matrix of the sub-graph */
-    while (con) {
-        if (spmNode == NULL || spmNode->colind > col) {
-            spmValue = 0;
-            con = 0;
-        } else if (spmNode->colind == col) {
-            spmValue = 1;
-            con = 0;
-        } else {
-            spmNode = spmNode->next;
-        }
-    }
-    return spmValue;
-}
-
 /**
  * Maximize modularity by moving nodes between the sub groups
  * @param group a group of vertices
@@ -75,7 +90,6 @@ double loopFindSpmValue(nodeRef spmNode, int col) {
  * @param numberOfPositiveVertices will be assigned the number of vertices in sub group A after the division
  */
 double maximizeModularity(Graph *G, VerticesGroup *group, double *s, unsigned int *numberOfPositiveVertices) {
-    nodeRef *adjRows, spmNode;
     double bestImprovement = 0, improve, modularity, maxScore, spmValue, bValue;
     int iteration, i, maxNode, prevMaxNode, bestIteration, isMaxSet, isSetBestImprovement;
     char *hasMoved;
@@ -91,9 +105,9 @@ double maximizeModularity(Graph *G, VerticesGroup *group, double *s, unsigned in
     assertMemoryAllocation(score);
     x = malloc(group->size * sizeof(double));
     assertMemoryAllocation(x);
-    adjRows = group->edgeSubMatrix->private;
 
     do {
+        STATS_COUNT(STATS_COUNTER_REFINEMENT_PASSES, group->depth, 1);
         multiplyModularityByVector(G, group, s, x, 0, 0, 0);
 
         bestImprovement = 0;
@@ -110,8 +124,7 @@ double maximizeModularity(Graph *G, VerticesGroup *group, double *s, unsigned in
                                     pow(G->degrees[group->verticesArr[i]], 2) /
                                     G->degreeSum);
                     } else {
-                        spmNode = adjRows[i];
-                        spmValue = loopFindSpmValue(spmNode, prevMaxNode);
+                        spmValue = group->edgeSubMatrix->get(group->edgeSubMatrix, i, prevMaxNode);
                         bValue = spmValue - getExpectedEdges(G, group->verticesArr[i], group->verticesArr[prevMaxNode]);
                         score[i] -= 4 * s[i] * s[prevMaxNode] * bValue;
                     }
@@ -157,49 +170,366 @@ double maximizeModularity(Graph *G, VerticesGroup *group, double *s, unsigned in
 }
 
 /**
- * Divide a group into two.
+ * Divide a group into two by the leading eigenvector of its modularity matrix, and refine the division.
+ * The modularity sub matrix of the group should be calculated already, it is freed here.
  * @param G graph object
  * @param group vertices group
- * @param vector an empty allocated array the capacity of the graph's vertices, used for power iteration
- * @param s an empty allocated array the capacity of the graph's vertices, used for storing an eigenvector
+ * @param lambda the leading eigenvalue of the group's modularity matrix
+ * @param s the corresponding eigenvector, will be assigned the division
  * @param newGroupA the first divided group will be assigned to this parameter (or left as NULL)
  * @param newGroupB the second divided group will be assigned to this parameter (or left as NULL)
  */
-void divisionAlgorithm2(Graph *G, VerticesGroup *group, double *vector, double *s, VerticesGroup **newGroupA,
-                        VerticesGroup **newGroupB) {
+void divideByLeadingEigenvector(Graph *G, VerticesGroup *group, double lambda, double *s, VerticesGroup **newGroupA,
+                                VerticesGroup **newGroupB) {
     int i;
-    double lambda, modularity;
+    double modularity;
     unsigned int numberOfPositiveVertices = 0;
 
-    calculateModularitySubMatrix(G, group);
-    randVector(vector, group->size);
-    lambda = powerIteration(G, group, vector, s);
     if (IS_POSITIVE(lambda)) {
         /* turn s eigenvector into +1 and -1 */
         for (i = 0; i < group->size; i++) {
             s[i] = IS_POSITIVE(s[i]) ? 1 : -1;
         }
 
+        STATS_START(STATS_PHASE_REFINEMENT);
         modularity = maximizeModularity(G, group, s, &numberOfPositiveVertices);
+        STATS_STOP(STATS_PHASE_REFINEMENT, group->depth);
 
         if (IS_POSITIVE(modularity)) {
+            STATS_COUNT(STATS_COUNTER_SPLITS_ACCEPTED, group->depth, 1);
             divideGroupByEigenvector(group, s, newGroupA, newGroupB, numberOfPositiveVertices);
+        } else {
+            STATS_COUNT(STATS_COUNTER_REJECTED_MODULARITY, group->depth, 1);
         }
+    } else {
+        STATS_COUNT(STATS_COUNTER_REJECTED_EIGENVALUE, group->depth, 1);
     }
     freeVerticesGroupModularitySubMatrix(group);
 }
 
 /**
- * Divide a graph into densely connected groups, forming a Community Structure
+ * Check whether a group is divided by the sparse engine (power iteration on the linked-list sub matrix).
+ * @param settings division settings
+ * @param group vertices group
+ * @return 1 if the group is too large for the dense and exact engines, 0 otherwise
+ */
+int isSparseGroup(DivisionSettings *settings, VerticesGroup *group) {
+    return group->size > settings->exactThreshold && group->size > settings->denseThreshold;
+}
+
+/**
+ * Check whether the edges of a group fill a given fraction of its sub matrix.
  * @param G graph object
- * @return a list of groups
+ * @param group vertices group
+ * @param density the fraction, between 0 and 1
+ * @return 1 if the group is at least that dense, 0 otherwise
+ */
+static int isDenseGroup(Graph *G, VerticesGroup *group, double density) {
+    int i, *innerDegrees = malloc(group->size * sizeof(int));
+    double edges = 0;
+    assertMemoryAllocation(innerDegrees);
+    countInnerDegrees(G, group, innerDegrees);
+    for (i = 0; i < group->size; i++) {
+        edges += innerDegrees[i];
+    }
+    free(innerDegrees);
+    return edges >= density * group->size * group->size;
+}
+
+/**
+ * Calculate the modularity sub matrix of a group of the sparse engine, in the format chosen by the settings.
+ * @param G graph object
+ * @param settings division settings
+ * @param group vertices group
+ */
+void calculateSparseSubMatrix(Graph *G, DivisionSettings *settings, VerticesGroup *group) {
+    STATS_START(STATS_PHASE_SUBMATRIX);
+    if (settings->bitsetDensity > 0 && isDenseGroup(G, group, settings->bitsetDensity)) {
+        calculateBitsetModularitySubMatrix(G, group);
+    } else {
+        switch (settings->storage) {
+            case STORAGE_SYMMETRIC:
+                calculateSymmetricModularitySubMatrix(G, group);
+                break;
+            case STORAGE_COMPRESSED:
+                calculateCompressedModularitySubMatrix(G, group);
+                break;
+            case STORAGE_SELL:
+                calculateSellModularitySubMatrix(G, group);
+                break;
+            case STORAGE_MERGE_PATH:
+                calculateMergePathModularitySubMatrix(G, group, settings->threads);
+                break;
+            default:
+                calculateModularitySubMatrix(G, group);
+        }
+    }
+    STATS_STOP(STATS_PHASE_SUBMATRIX, group->depth);
+}
+
+/**
+ * Divide a group into two.
+ * @param G graph object
+ * @param settings division settings
+ * @param group vertices group
+ * @param vector an empty allocated array the capacity of the graph's vertices, used for power iteration
+ * @param s an empty allocated array the capacity of the graph's vertices, used for storing an eigenvector
+ * @param newGroupA the first divided group will be assigned to this parameter (or left as NULL)
+ * @param newGroupB the second divided group will be assigned to this parameter (or left as NULL)
+ */
+void divisionAlgorithm2(Graph *G, DivisionSettings *settings, VerticesGroup *group, double *vector, double *s,
+                        VerticesGroup **newGroupA, VerticesGroup **newGroupB) {
+    double lambda;
+    Rng rng;
+
+    STATS_COUNT(STATS_COUNTER_GROUPS, group->depth, 1);
+    if (settings->preChecks && isIndivisibleGroup(G, group)) {
+        STATS_COUNT(STATS_COUNTER_REJECTED_PRECHECK, group->depth, 1);
+        return;
+    }
+    if (group->size <= settings->exactThreshold) {
+        exactDivisionAlgorithm(G, group, s, newGroupA, newGroupB);
+        return;
+    }
+    if (group->size <= settings->denseThreshold) {
+        denseDivisionAlgorithm(G, group, s, newGroupA, newGroupB);
+        return;
+    }
+
+    calculateSparseSubMatrix(G, settings, group);
+    STATS_START(STATS_PHASE_EIGEN);
+    /* a group is identified by its smallest vertex and its size (vertices are kept in increasing order) */
+    seedRng(&rng, settings->seed, group->verticesArr[0], group->size);
+    randVector(vector, group->size, &rng);
+    if (settings->chebyshev) {
+        lambda = chebyshevPowerIteration(G, group, vector, s);
+    } else if (settings->signStableIterations > 0) {
+        lambda = powerIterationUntilStableSigns(G, group, vector, s, settings->signStableIterations);
+    } else {
+        lambda = powerIteration(G, group, vector, s);
+    }
+    STATS_STOP(STATS_PHASE_EIGEN, group->depth);
+    divideByLeadingEigenvector(G, group, lambda, s, newGroupA, newGroupB);
+}
+
+/**
+ * Find the connected components of a graph by BFS, and use them as the initial groups of the division.
+ * Splitting a group along its components never decreases the modularity, so every component is a union of
+ * final groups. Components of a single (isolated) vertex are final already.
+ * @param G graph object
+ * @param P the list of groups to divide, components of two vertices or more are added to it
+ * @param O the list of final groups, isolated vertices are added to it
+ */
+void addConnectedComponents(Graph *G, LinkedList *P, LinkedList *O) {
+    nodeRef *rows = (nodeRef *) G->adjMat->private;
+    nodeRef neighbor;
+    int *component, *queue, *sizes;
+    VerticesGroup **groups;
+    int v, head, tail, componentsCount = 0;
+
+    component = malloc(G->n * sizeof(int));
+    assertMemoryAllocation(component);
+    queue = malloc(G->n * sizeof(int));
+    assertMemoryAllocation(queue);
+    sizes = malloc(G->n * sizeof(int));
+    assertMemoryAllocation(sizes);
+    for (v = 0; v < G->n; v++) {
+        component[v] = -1;
+    }
+
+    /* label the vertices of every component */
+    for (v = 0; v < G->n; v++) {
+        if (component[v] != -1)
+            continue;
+        component[v] = componentsCount;
+        head = 0;
+        tail = 0;
+        queue[tail++] = v;
+        while (head < tail) {
+            for (neighbor = rows[queue[head++]]; neighbor != NULL; neighbor = neighbor->next) {
+                if (component[neighbor->colind] == -1) {
+                    component[neighbor->colind] = componentsCount;
+                    queue[tail++] = neighbor->colind;
+                }
+            }
+        }
+        sizes[componentsCount++] = tail;
+    }
+
+    /* vertices are added in increasing order, as the division algorithm expects */
+    groups = malloc(componentsCount * sizeof(VerticesGroup *));
+    assertMemoryAllocation(groups);
+    for (v = 0; v < componentsCount; v++) {
+        groups[v] = createVerticesGroup(sizes[v]);
+        insertItem(sizes[v] == 1 ? O : P, groups[v]);
+    }
+    for (v = 0; v < G->n; v++) {
+        addVertexToGroup(groups[component[v]], v);
+    }
+
+    free(groups);
+    free(sizes);
+    free(queue);
+    free(component);
+}
+
+/* the items of the groups to divide, as a binary max-heap by the size of their groups, when there is a deadline */
+typedef struct _groupHeap {
+    LinkedListNode **items;
+    int count;
+    int capacity;
+} GroupHeap;
+
+/**
+ * Check whether a group is taken before another one: the larger first, and the one of the smaller first vertex on
+ * ties, so the order does not depend on the order of the list.
+ */
+static int isTakenBefore(LinkedListNode *first, LinkedListNode *second) {
+    VerticesGroup *x = first->pointer, *y = second->pointer;
+    return x->size != y->size ? x->size > y->size : x->verticesArr[0] < y->verticesArr[0];
+}
+
+/**
+ * Add an item of the groups to divide to a heap.
+ * @param heap the heap of the groups to divide
+ * @param item the item of the group in the list of the groups to divide
+ */
+static void pushGroup(GroupHeap *heap, LinkedListNode *item) {
+    int i = heap->count++;
+    if (heap->count > heap->capacity) {
+        heap->capacity = 2 * heap->count;
+        heap->items = realloc(heap->items, heap->capacity * sizeof(LinkedListNode *));
+        assertMemoryAllocation(heap->items);
+    }
+    for (; i > 0 && isTakenBefore(item, heap->items[(i - 1) / 2]); i = (i - 1) / 2) {
+        heap->items[i] = heap->items[(i - 1) / 2];
+    }
+    heap->items[i] = item;
+}
+
+/**
+ * Remove the item of the largest group from a heap.
+ * @param heap a non-empty heap of the groups to divide
+ * @return the item of the largest group
  */
-LinkedList *divisionAlgorithm(Graph *G) {
+static LinkedListNode *popLargestGroup(GroupHeap *heap) {
+    LinkedListNode *largest = heap->items[0], *last = heap->items[--heap->count];
+    int i = 0, child;
+    for (child = 1; child < heap->count; i = child, child = 2 * child + 1) {
+        if (child + 1 < heap->count && isTakenBefore(heap->items[child + 1], heap->items[child])) {
+            child++;
+        }
+        if (!isTakenBefore(heap->items[child], last)) {
+            break;
+        }
+        heap->items[i] = heap->items[child];
+    }
+    heap->items[i] = last;
+    return largest;
+}
+
+/**
+ * Move the result of a group's multi-way division to the worklist and the final groups list.
+ * @param G graph object
+ * @param settings division settings, the split is recorded in its dendrogram if there is one
+ * @param P the list of groups to divide
+ * @param largest the heap of the groups to divide, NULL if there is no deadline
+ * @param O the list of final groups
+ * @param group the divided group, freed if it was split
+ * @param parts the sub groups
+ * @param partsCount the number of sub groups, 0 if the group is indivisible
+ */
+static void collectParts(Graph *G, DivisionSettings *settings, LinkedList *P, GroupHeap *largest, LinkedList *O,
+                         VerticesGroup *group, VerticesGroup **parts, int partsCount) {
     int i;
-    double *vector, *s;
+    if (partsCount == 0) {
+        insertItem(O, group);
+    } else {
+        if (settings->dendrogram != NULL) {
+            recordSplit(settings->dendrogram, G, group, parts, partsCount);
+        }
+        for (i = 0; i < partsCount; i++) {
+            if (parts[i]->size == 1) {
+                insertItem(O, parts[i]);
+            } else if (largest != NULL) {
+                pushGroup(largest, insertItem(P, parts[i]));
+            } else {
+                insertItem(P, parts[i]);
+            }
+        }
+        freeVerticesGroup(group);
+    }
+}
+
+/**
+ * Move the result of a group's division to the worklist and the final groups list.
+ * @param G graph object
+ * @param settings division settings
+ * @param P the list of groups to divide
+ * @param largest the heap of the groups to divide, NULL if there is no deadline
+ * @param O the list of final groups
+ * @param group the divided group, freed if it was split
+ * @param groupA the first sub group, NULL if the group is indivisible
+ * @param groupB the second sub group, NULL if the group is indivisible
+ */
+static void collectDivision(Graph *G, DivisionSettings *settings, LinkedList *P, GroupHeap *largest, LinkedList *O,
+                            VerticesGroup *group, VerticesGroup *groupA, VerticesGroup *groupB) {
+    VerticesGroup *parts[2];
+    parts[0] = groupA;
+    parts[1] = groupB;
+    collectParts(G, settings, P, largest, O, group, parts, groupA == NULL || groupB == NULL ? 0 : 2);
+}
+
+/**
+ * Read the monotonic clock.
+ * @return the current time in seconds, from an arbitrary starting point.
+ */
+static double wallClockSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
+
+/**
+ * Move the groups left to divide to the final groups list, as they are, when the deadline passed.
+ * @param P the list of groups to divide, is emptied
+ * @param O the list of final groups
+ */
+static void finishAtDeadline(LinkedList *P, LinkedList *O) {
+    VerticesGroup *group;
+    while (P->first != NULL) {
+        group = P->first->pointer;
+        removeItem(P, P->first);
+        STATS_COUNT(STATS_COUNTER_DEADLINE_GROUPS, group->depth, 1);
+        STATS_COUNT(STATS_COUNTER_DEADLINE_VERTICES, group->depth, group->size);
+        insertItem(O, group);
+    }
+}
+
+/**
+ * Divide a graph into densely connected groups, forming a Community Structure.
+ * With a deadline, the groups are divided largest first (kept in a heap, as the connected components may be many),
+ * and once it passed the groups left are final, so the result is always a partition of the graph.
+ * A division already started runs to its end, so the deadline can be overrun by the time of one group's division.
+ * With a checkpoint path, the lists of groups are saved periodically, and a division can start from such a
+ * checkpoint instead of from the graph (see checkpoint.h).
+ * With a dendrogram, every accepted split is recorded in it, from the groups the division starts with, which
+ * cannot be the ones of a checkpoint.
+ * @param G graph object
+ * @param settings division settings
+ * @return a list of groups
+ */
+LinkedList *divisionAlgorithm(Graph *G, DivisionSettings *settings) {
+    int i, remaining, batchCount, batchCapacity = settings->batchSize > 1 ? settings->batchSize : 1, partsCount;
+    double *vector, *s, start = wallClockSeconds();
     LinkedList *P, *O;
+    LinkedListNode *item, *next;
     VerticesGroup *group, *groupA, *groupB;
+    VerticesGroup **batch, **batchA, **batchB, **parts;
+    Checkpointer checkpointer;
+    GroupHeap heap, *largest = NULL;
 
+    STATS_START(STATS_PHASE_DIVISION);
     P = createLinkedList();
     O = createLinkedList();
 
@@ -207,59 +537,108 @@ LinkedList *divisionAlgorithm(Graph *G) {
     assertMemoryAllocation(vector);
     s = malloc(G->n * sizeof(double));
     assertMemoryAllocation(s);
-    group = createVerticesGroup(G->n);
-    for (i = 0; i < G->n; i++) {
-        addVertexToGroup(group, i);
+    batch = malloc(batchCapacity * sizeof(VerticesGroup *));
+    assertMemoryAllocation(batch);
+    batchA = malloc(batchCapacity * sizeof(VerticesGroup *));
+    assertMemoryAllocation(batchA);
+    batchB = malloc(batchCapacity * sizeof(VerticesGroup *));
+    assertMemoryAllocation(batchB);
+    parts = malloc(2 * (settings->splitVectors > 1 ? settings->splitVectors : 1) * sizeof(VerticesGroup *));
+    assertMemoryAllocation(parts);
+    if (settings->resumePath != NULL) {
+        if (settings->dendrogram != NULL) {
+            throw("A dendrogram cannot be recorded from a checkpoint");
+        }
+        loadCheckpoint(settings->resumePath, P, O, G->n, &settings->seed);
+    } else if (settings->splitComponents) {
+        addConnectedComponents(G, P, O);
+    } else {
+        /* unsupported case because of division by 0 */
+        if (G->degreeSum == 0) {
+            throw("Degrees sum of 0 is not supported because of division by 0");
+        }
+        group = createVerticesGroup(G->n);
+        for (i = 0; i < G->n; i++) {
+            addVertexToGroup(group, i);
+        }
+        insertItem(P, group);
+    }
+    if (settings->dendrogram != NULL) {
+        addDendrogramRoots(settings->dendrogram, P);
+        addDendrogramRoots(settings->dendrogram, O);
+    }
+    if (settings->deadline > 0) {
+        largest = &heap;
+        heap.count = 0;
+        heap.capacity = P->length > 0 ? P->length : 1;
+        heap.items = malloc(heap.capacity * sizeof(LinkedListNode *));
+        assertMemoryAllocation(heap.items);
+        item = P->first;
+        for (remaining = P->length; remaining > 0; remaining--) {
+            pushGroup(largest, item);
+            item = item->next;
+        }
     }
-    insertItem(P, group);
+    initCheckpointer(&checkpointer, settings->checkpointPath, settings->checkpointInterval, start);
     while (P->first != NULL) {
-        groupA = NULL;
-        groupB = NULL;
-        group = P->first->pointer;
-        removeItem(P, P->first);
-        divisionAlgorithm2(G, group, vector, s, &groupA, &groupB);
-        if (groupA == NULL || groupB == NULL) {
-            insertItem(O, group);
-        } else {
-            if (groupA->size == 1) {
-                insertItem(O, groupA);
+        if (settings->deadline > 0 && wallClockSeconds() - start >= settings->deadline) {
+            finishAtDeadline(P, O);
+            break;
+        }
+        item = largest != NULL ? popLargestGroup(largest) : P->first;
+        group = item->pointer;
+        removeItem(P, item);
+        if (settings->batchSize > 1 && isSparseGroup(settings, group)) {
+            /* gather more groups of the sparse engine, and solve their eigenproblems together */
+            batch[0] = group;
+            batchCount = 1;
+            if (largest != NULL) {
+                /* the next largest groups, the sparse engine's groups being the ones above a size */
+                while (largest->count > 0 && batchCount < settings->batchSize &&
+                       isSparseGroup(settings, largest->items[0]->pointer)) {
+                    item = popLargestGroup(largest);
+                    batch[batchCount++] = item->pointer;
+                    removeItem(P, item);
+                }
             } else {
-                insertItem(P, groupA);
+                item = P->first;
+                /* the list is circular, so it is walked by its length */
+                for (remaining = P->length; remaining > 0 && batchCount < settings->batchSize; remaining--) {
+                    next = item->next;
+                    if (isSparseGroup(settings, item->pointer)) {
+                        batch[batchCount++] = item->pointer;
+                        removeItem(P, item);
+                    }
+                    item = next;
+                }
             }
-            if (groupB->size == 1) {
-                insertItem(O, groupB);
-            } else {
-                insertItem(P, groupB);
+            batchDivisionAlgorithm(G, settings, batch, batchCount, vector, s, batchA, batchB);
+            for (i = 0; i < batchCount; i++) {
+                collectDivision(G, settings, P, largest, O, batch[i], batchA[i], batchB[i]);
             }
-            freeVerticesGroup(group);
+        } else if (settings->splitVectors > 1 && isSparseGroup(settings, group)) {
+            partsCount = multiwayDivisionAlgorithm(G, settings, group, s, parts);
+            collectParts(G, settings, P, largest, O, group, parts, partsCount);
+        } else {
+            groupA = NULL;
+            groupB = NULL;
+            divisionAlgorithm2(G, settings, group, vector, s, &groupA, &groupB);
+            collectDivision(G, settings, P, largest, O, group, groupA, groupB);
         }
+        checkpointIfDue(&checkpointer, P, O, G->n, settings->seed, wallClockSeconds());
     }
+    finishCheckpoints(&checkpointer);
 
+    if (largest != NULL) {
+        free(heap.items);
+    }
+    free(batch);
+    free(batchA);
+    free(batchB);
+    free(parts);
     free(vector);
     free(s);
     deepFreeGroupList(P);
+    STATS_STOP(STATS_PHASE_DIVISION, -1);
     return O;
 }
-
-/**
- * Save the list of sub groups to an output file
- * @param groupLst list of vertices groups
- * @param output_path path of output file
- */
-void saveOutputToFile(LinkedList *groupLst, char *output_path) {
-    FILE *output_file = fopen(output_path, "wb");
-    LinkedListNode *currentNode = groupLst->first;
-    VerticesGroup *currentGroup;
-    int i;
-    assertFileOpen(output_file, output_path);
-    assertFileWrite(fwrite(&groupLst->length, sizeof(int), 1, output_file), 1, output_path);
-    for (i = 0; i < groupLst->length; ++i) {
-        currentGroup = currentNode->pointer;
-        assertFileWrite(fwrite(&currentGroup->size, sizeof(int), 1, output_file), 1, output_path);
-        assertFileWrite(fwrite(currentGroup->verticesArr, sizeof(int), currentGroup->size, output_file),
-                        currentGroup->size, output_path);
-
-        currentNode = currentNode->next;
-    }
-    fclose(output_file);
-}
@@ -5,19 +5,97 @@
 #include "graph.h"
 #include "VerticesGroup.h"
 #include "LinkedList.h"
+#include "rng.h"
+#include "dendrogram.h"
 
-LinkedList *divisionAlgorithm(Graph *G);
+/* groups of up to this many vertices are divided by the dense engine (see dense.h) */
+#define DEFAULT_DENSE_THRESHOLD 128
+/* groups of up to this many vertices are divided optimally by the exact solver (see exact.h), which costs about as
+ * much as the dense engine up to here, and doubles with every vertex beyond */
+#define DEFAULT_EXACT_THRESHOLD 10
+/* groups with at least this fraction of their vertex pairs connected keep their edges in a bit matrix */
+#define DEFAULT_BITSET_DENSITY 0.05
 
-void randVector(double *vector, int n);
+/* the graph's own edges (G->adjMat) are always kept in linked lists, the formats apply to the copies of the groups */
+typedef enum _subMatrixStorage {
+    /* a linked list of every row (spmat_allocate_list) */
+    STORAGE_LISTS,
+    /* the upper triangle only (spmat_allocate_symmetric) */
+    STORAGE_SYMMETRIC,
+    /* varint-encoded column gaps (spmat_allocate_compressed) */
+    STORAGE_COMPRESSED,
+    /* sliced ELLPACK, in chunks of the SIMD width (spmat_allocate_sell) */
+    STORAGE_SELL,
+    /* the arrays format, multiplied by settings->threads threads (spmat_allocate_merge_path) */
+    STORAGE_MERGE_PATH
+} SubMatrixStorage;
+
+typedef struct _divisionSettings {
+    /* seed of the run. The random start vector of every group is derived from it and from the group itself,
+     * so equal seeds give equal divisions, whatever the order in which groups are processed. */
+    unsigned long seed;
+    /* whether the connected components of the graph are separated before the first eigen-solve */
+    int splitComponents;
+    /* groups of up to this many vertices are divided by the dense engine, 0 disables it */
+    int denseThreshold;
+    /* groups of up to this many vertices (at most EXACT_MAX_GROUP_SIZE) are divided optimally, 0 disables it */
+    int exactThreshold;
+    /* up to this many groups of the sparse engine (above the dense and exact thresholds) have their eigenproblems
+     * solved together (see batch.h), 0 or 1 disables batching */
+    int batchSize;
+    /* whether groups which are cheaply proven indivisible skip the solve (see indivisible.h) */
+    int preChecks;
+    /* the sparse format of the groups' edges in the sparse engine.
+     * Batched groups are always kept in linked lists, as the batch copies them into one block-diagonal matrix. */
+    SubMatrixStorage storage;
+    /* the number of threads multiplying the groups' edges, when stored as STORAGE_MERGE_PATH */
+    int threads;
+    /* groups of the sparse engine whose edges fill at least this fraction of their sub matrix keep them in a bit
+     * matrix (spmat_allocate_bitset), whatever the storage, 0 disables it */
+    double bitsetDensity;
+    /* when positive, the power iteration stops once the signs of its vector did not change for this many iterations
+     * and the Rayleigh quotient is stable (see powerIterationUntilStableSigns), 0 waits for full convergence.
+     * Batched groups always wait for full convergence. */
+    int signStableIterations;
+    /* whether the sparse engine finds the leading eigenvector by a Chebyshev-filtered power iteration
+     * (see chebyshev.h), instead of the 1-norm shifted one. Batched groups always use the shifted one. */
+    int chebyshev;
+    /* when at least 2, every group of the sparse engine is divided at once into up to twice this many parts, by
+     * this many leading eigenvectors (see multiway.h), 0 or 1 bisects. Batched groups are always bisected. */
+    int splitVectors;
+    /* when positive, the division stops after this many seconds (wall-clock, from its start), and the groups not
+     * divided yet are final. Groups are then divided largest first. 0 divides until every group is final. */
+    double deadline;
+    /* when not NULL, the lists of groups are saved to this file every checkpointInterval seconds (see checkpoint.h) */
+    char *checkpointPath;
+    double checkpointInterval;
+    /* when not NULL, the division continues from this checkpoint, whose seed replaces the seed above */
+    char *resumePath;
+    /* when not NULL, every accepted split is recorded in this dendrogram (see dendrogram.h) */
+    Dendrogram *dendrogram;
+} DivisionSettings;
+
+void initDivisionSettings(DivisionSettings *settings);
+
+void addConnectedComponents(Graph *G, LinkedList *P, LinkedList *O);
+
+LinkedList *divisionAlgorithm(Graph *G, DivisionSettings *settings);
+
+void randVector(double *vector, int n, Rng *rng);
 
 void divideGroupByEigenvector(VerticesGroup *group, double *s, VerticesGroup **splitGroupA, VerticesGroup **splitGroupB,
                               unsigned int numberOfPositiveVertices);
 
 double maximizeModularity(Graph *G, VerticesGroup *group, double *s, unsigned int *numberOfPositiveVertices);
 
-void divisionAlgorithm2(Graph *G, VerticesGroup *group, double *vector, double *s, VerticesGroup **newGroupA,
-                        VerticesGroup **newGroupB);
+void divideByLeadingEigenvector(Graph *G, VerticesGroup *group, double lambda, double *s, VerticesGroup **newGroupA,
+                                VerticesGroup **newGroupB);
+
+int isSparseGroup(DivisionSettings *settings, VerticesGroup *group);
+
+void calculateSparseSubMatrix(Graph *G, DivisionSettings *settings, VerticesGroup *group);
 
-void saveOutputToFile(LinkedList *groupLst, char *output_path);
+void divisionAlgorithm2(Graph *G, DivisionSettings *settings, VerticesGroup *group, double *vector, double *s,
+                        VerticesGroup **newGroupA, VerticesGroup **newGroupB);
 
 #endif
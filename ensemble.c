@@ -0,0 +1,136 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include "ensemble.h"
+#include "spmat.h"
+#include "ErrorHandler.h"
+
+typedef struct _ensembleRun {
+    Graph *G;
+    DivisionSettings settings;
+    LinkedList *groupLst;
+    double modularity;
+} EnsembleRun;
+
+/**
+ * Calculate the modularity of a division, in time linear in the number of vertices and edges.
+ * @param G graph object
+ * @param groupLst a partition of the graph's vertices into groups
+ * @return the modularity of the division
+ */
+double evaluateDivisionModularity(Graph *G, LinkedList *groupLst) {
+    nodeRef *rows = (nodeRef *) G->adjMat->private;
+    nodeRef neighbor;
+    LinkedListNode *currentNode = groupLst->first;
+    VerticesGroup *currentGroup;
+    double innerEdges = 0, degrees, expectedEdges = 0;
+    int i, j, *labels = malloc(G->n * sizeof(int));
+    assertMemoryAllocation(labels);
+    if (G->degreeSum == 0) {
+        free(labels);
+        return 0;
+    }
+
+    for (i = 0; i < groupLst->length; ++i) {
+        currentGroup = currentNode->pointer;
+        degrees = 0;
+        for (j = 0; j < currentGroup->size; ++j) {
+            labels[currentGroup->verticesArr[j]] = i;
+            degrees += G->degrees[currentGroup->verticesArr[j]];
+        }
+        expectedEdges += degrees * degrees / G->degreeSum;
+        currentNode = currentNode->next;
+    }
+    for (i = 0; i < G->n; ++i) {
+        for (neighbor = rows[i]; neighbor != NULL; neighbor = neighbor->next) {
+            if (labels[neighbor->colind] == labels[i]) {
+                innerEdges += neighbor->value;
+            }
+        }
+    }
+    free(labels);
+    return (innerEdges - expectedEdges) / G->degreeSum;
+}
+
+/**
+ * Divide the graph with the settings of a single run, and score the division.
+ * @param argument the run (an EnsembleRun)
+ * @return NULL
+ */
+static void *runDivision(void *argument) {
+    EnsembleRun *run = (EnsembleRun *) argument;
+    run->groupLst = divisionAlgorithm(run->G, &run->settings);
+    run->modularity = evaluateDivisionModularity(run->G, run->groupLst);
+    return NULL;
+}
+
+/**
+ * Divide a graph by several runs of different seeds, and keep the division of the highest modularity.
+ * With a dendrogram in the settings, every run records its own, and the dendrogram of the kept run replaces it.
+ * @param G graph object
+ * @param settings division settings, run i is seeded by settings->seed + i
+ * @param runs the number of runs, between 1 and ENSEMBLE_MAX_RUNS
+ * @return the list of groups of the best run
+ */
+LinkedList *ensembleDivisionAlgorithm(Graph *G, DivisionSettings *settings, int runs) {
+    EnsembleRun *ensemble;
+    Dendrogram swap;
+    pthread_t *workers;
+    LinkedList *best;
+    int i, bestRun = 0;
+    if (runs < 1 || runs > ENSEMBLE_MAX_RUNS) {
+        throw("The number of runs of an ensemble should be between 1 and 256");
+    }
+    if (settings->checkpointPath != NULL || settings->resumePath != NULL) {
+        throw("Checkpoints are not supported by an ensemble");
+    }
+    ensemble = malloc(runs * sizeof(EnsembleRun));
+    assertMemoryAllocation(ensemble);
+    workers = malloc(runs * sizeof(pthread_t));
+    assertMemoryAllocation(workers);
+    for (i = 0; i < runs; ++i) {
+        ensemble[i].G = G;
+        ensemble[i].settings = *settings;
+        ensemble[i].settings.seed = settings->seed + (unsigned long) i;
+        if (settings->dendrogram != NULL && i > 0) {
+            ensemble[i].settings.dendrogram = createDendrogram();
+        }
+    }
+
+#ifdef CLUSTER_STATS
+    for (i = 0; i < runs; ++i) {
+        runDivision(&ensemble[i]);
+    }
+#else
+    /* the calling thread takes the first run */
+    for (i = 1; i < runs; ++i) {
+        assertBooleanStatementIsTrue(pthread_create(&workers[i], NULL, runDivision, &ensemble[i]) == 0);
+    }
+    runDivision(&ensemble[0]);
+    for (i = 1; i < runs; ++i) {
+        pthread_join(workers[i], NULL);
+    }
+#endif
+
+    for (i = 1; i < runs; ++i) {
+        if (ensemble[i].modularity > ensemble[bestRun].modularity) {
+            bestRun = i;
+        }
+    }
+    if (settings->dendrogram != NULL && bestRun > 0) {
+        swap = *settings->dendrogram;
+        *settings->dendrogram = *ensemble[bestRun].settings.dendrogram;
+        *ensemble[bestRun].settings.dendrogram = swap;
+    }
+    for (i = 0; i < runs; ++i) {
+        if (i != bestRun) {
+            deepFreeGroupList(ensemble[i].groupLst);
+        }
+        if (settings->dendrogram != NULL && i > 0) {
+            freeDendrogram(ensemble[i].settings.dendrogram);
+        }
+    }
+    best = ensemble[bestRun].groupLst;
+    free(workers);
+    free(ensemble);
+    return best;
+}
@@ -0,0 +1,25 @@
+#ifndef CLUSTER_ENSEMBLE_H
+#define CLUSTER_ENSEMBLE_H
+
+#include "graph.h"
+#include "LinkedList.h"
+#include "division.h"
+
+/* the most runs an ensemble is allowed */
+#define ENSEMBLE_MAX_RUNS 256
+
+/*
+ * An ensemble of divisions of one graph, differing only in their seeds, of which the best is kept.
+ * Run i is seeded by settings->seed + i, so every run can be reproduced alone. The runs share the graph, which none
+ * of them modifies, and run in threads of their own. Every division is scored by its modularity, in time linear in
+ * the number of edges, and the best one is kept (the first of them on ties, so the result does not depend on the
+ * order in which the threads finish).
+ * In a CLUSTER_STATS build the runs are one after another, as the statistics are process-wide, and they are summed
+ * over all runs.
+ */
+
+double evaluateDivisionModularity(Graph *G, LinkedList *groupLst);
+
+LinkedList *ensembleDivisionAlgorithm(Graph *G, DivisionSettings *settings, int runs);
+
+#endif
@@ -0,0 +1,103 @@
+#include <stdlib.h>
+#include "exact.h"
+#include "dense.h"
+#include "division.h"
+#include "defs.h"
+#include "ErrorHandler.h"
+#include "stats.h"
+
+/**
+ * Find the division of a tiny group with the maximum modularity delta, by enumerating all of them.
+ * Vertex 0 is kept in the first sub group (s and -s are the same division), and the other 2^(n-1)
+ * divisions are visited in Gray-code order. Every step moves a single vertex k, so s^T * B * s is
+ * updated in O(1) from y = B * s, and y itself in O(n).
+ * @param B the dense modularity matrix of the group, as built by buildDenseModularityMatrix
+ * @param rowSums the row sums of B
+ * @param n the size of the group, at most EXACT_MAX_GROUP_SIZE
+ * @param s will be assigned the best division as a +1/-1 vector
+ * @param numberOfPositiveVertices will be assigned the number of vertices in sub group A
+ * @return the modularity delta of the best division (0 if the group is indivisible)
+ */
+double exactMaximizeModularity(double *B, double *rowSums, int n, double *s, unsigned int *numberOfPositiveVertices) {
+    double *y = malloc(n * sizeof(double));
+    double *row, sBs = 0, bestSBs, rowSumsTotal = 0;
+    unsigned long step, steps, mask = 0, bestMask = 0;
+    int i, j, k;
+    assertMemoryAllocation(y);
+    assertBooleanStatementIsTrue(n <= EXACT_MAX_GROUP_SIZE);
+
+    /* start from the trivial division, s = (1, ..., 1) */
+    for (i = 0; i < n; i++) {
+        row = B + (size_t) i * n;
+        y[i] = 0;
+        for (j = 0; j < n; j++) {
+            y[i] += row[j];
+        }
+        sBs += y[i];
+        s[i] = 1;
+        rowSumsTotal += rowSums[i];
+    }
+    bestSBs = sBs;
+
+    steps = n > 1 ? 1UL << (n - 1) : 1;
+    for (step = 1; step < steps; step++) {
+        /* the Gray code of step differs from the previous one in its lowest set bit */
+        for (k = 0; !((step >> k) & 1UL); k++);
+        mask ^= 1UL << k;
+        k++;
+        row = B + (size_t) k * n;
+        sBs += 4 * (row[k] - s[k] * y[k]);
+        for (j = 0; j < n; j++) {
+            y[j] -= 2 * s[k] * row[j];
+        }
+        s[k] = -s[k];
+        if (sBs > bestSBs) {
+            bestSBs = sBs;
+            bestMask = mask;
+        }
+    }
+
+    *numberOfPositiveVertices = 0;
+    for (i = 0; i < n; i++) {
+        s[i] = (i > 0 && ((bestMask >> (i - 1)) & 1UL)) ? -1 : 1;
+        *numberOfPositiveVertices += (s[i] == 1);
+    }
+    free(y);
+    /* the modularity delta is 0.5 * s^T * B_hat[g] * s, where B_hat[g] = B[g] - diag(f) */
+    return 0.5 * (bestSBs - rowSumsTotal);
+}
+
+/**
+ * Divide a tiny group into two with the optimal division, or decide it is indivisible.
+ * @param G graph object
+ * @param group vertices group, of at most EXACT_MAX_GROUP_SIZE vertices
+ * @param s an allocated array the capacity of the graph's vertices, used for storing the division
+ * @param newGroupA the first divided group will be assigned to this parameter (or left as NULL)
+ * @param newGroupB the second divided group will be assigned to this parameter (or left as NULL)
+ */
+void exactDivisionAlgorithm(Graph *G, VerticesGroup *group, double *s, VerticesGroup **newGroupA,
+                            VerticesGroup **newGroupB) {
+    double *B, *rowSums, modularity;
+    unsigned int numberOfPositiveVertices = 0;
+
+    STATS_START(STATS_PHASE_SUBMATRIX);
+    rowSums = malloc(group->size * sizeof(double));
+    assertMemoryAllocation(rowSums);
+    B = buildDenseModularityMatrix(G, group, rowSums);
+    STATS_STOP(STATS_PHASE_SUBMATRIX, group->depth);
+
+    STATS_START(STATS_PHASE_EXACT);
+    modularity = exactMaximizeModularity(B, rowSums, group->size, s, &numberOfPositiveVertices);
+    STATS_STOP(STATS_PHASE_EXACT, group->depth);
+
+    if (IS_POSITIVE(modularity)) {
+        STATS_COUNT(STATS_COUNTER_SPLITS_ACCEPTED, group->depth, 1);
+        STATS_COUNT(STATS_COUNTER_EXACT_SPLITS, group->depth, 1);
+        divideGroupByEigenvector(group, s, newGroupA, newGroupB, numberOfPositiveVertices);
+    } else {
+        STATS_COUNT(STATS_COUNTER_REJECTED_MODULARITY, group->depth, 1);
+    }
+
+    free(B);
+    free(rowSums);
+}
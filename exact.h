@@ -0,0 +1,15 @@
+#ifndef CLUSTER_EXACT_H
+#define CLUSTER_EXACT_H
+
+#include "graph.h"
+#include "VerticesGroup.h"
+
+/* the largest group the exact solver accepts (2^(n-1) divisions are enumerated) */
+#define EXACT_MAX_GROUP_SIZE 30
+
+double exactMaximizeModularity(double *B, double *rowSums, int n, double *s, unsigned int *numberOfPositiveVertices);
+
+void exactDivisionAlgorithm(Graph *G, VerticesGroup *group, double *s, VerticesGroup **newGroupA,
+                            VerticesGroup **newGroupB);
+
+#endif
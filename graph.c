@@ -18,6 +18,7 @@ Graph *constructGraphFromInput(char *inputFilePath) {
     assertMemoryAllocation(list);
     G->n = n;
     G->degreeSum = 0;
+    G->originalIndices = NULL;
     G->adjMat = spmat_allocate_list(n);
 
     for (i = 0; i < n; ++i) {
@@ -34,11 +35,6 @@ Graph *constructGraphFromInput(char *inputFilePath) {
         free(row);
     }
 
-    /* unsupported case because of division by 0 */
-    if (G->degreeSum == 0) {
-        throw("Degrees sum of 0 is not supported because of division by 0");
-    }
-
     fclose(graph_file);
     free(list);
 
@@ -61,5 +57,6 @@ double getExpectedEdges(Graph *G, int i, int j) {
 void destroyGraph(Graph *G) {
     G->adjMat->free(G->adjMat);
     free(G->degrees);
+    free(G->originalIndices);
     free(G);
 }
@@ -15,6 +15,8 @@ typedef struct _graph {
     int *degrees;
     /* sum of vertices' degrees */
     int degreeSum;
+    /* originalIndices[v] is the index vertex v had in the input, or NULL if the vertices were not relabeled */
+    int *originalIndices;
 
 } Graph;
 
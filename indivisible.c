@@ -0,0 +1,90 @@
+#include <stdlib.h>
+#include "indivisible.h"
+#include "ErrorHandler.h"
+
+/*
+ * Notation: n is the size of the group g, d_i is the number of neighbors of i inside g, k_i is the degree of i,
+ * K is the sum of the degrees of g and M is the sum of all degrees.
+ * Dividing g into S and T changes the modularity by -2 * (e(S,T) - K_S * K_T / M), where e(S,T) counts the edges
+ * between S and T, so g is indivisible when no cut of g is sparser than its expected number of edges.
+ */
+
+/**
+ * Check whether the only division of a pair of vertices is unprofitable: -2 * (A_ij - k_i * k_j / M) <= 0.
+ */
+static int isIndivisiblePair(Graph *G, VerticesGroup *group, int *innerDegrees) {
+    double degreesProduct = (double) G->degrees[group->verticesArr[0]] * G->degrees[group->verticesArr[1]];
+    return (double) innerDegrees[0] * G->degreeSum >= degreesProduct;
+}
+
+/**
+ * Check whether a group is a star whose leaves are all attached weakly enough to the rest of the graph.
+ * Every cut of a star separates a set T of leaves from the center, so e(S,T) = |T|, and K_S * K_T / M <= |T| holds
+ * when k_l * K <= M for every leaf l.
+ */
+static int isIndivisibleStar(Graph *G, VerticesGroup *group, int *innerDegrees, double degreesSum) {
+    int i, center = -1;
+    double maxLeafDegree = 0;
+    for (i = 0; i < group->size; i++) {
+        if (innerDegrees[i] == group->size - 1 && center == -1) {
+            center = i;
+        } else if (innerDegrees[i] != 1) {
+            return 0;
+        } else if (G->degrees[group->verticesArr[i]] > maxLeafDegree) {
+            maxLeafDegree = G->degrees[group->verticesArr[i]];
+        }
+    }
+    return center != -1 && maxLeafDegree * degreesSum <= G->degreeSum;
+}
+
+/**
+ * Check whether a group is a clique or a near-clique, by a spectral bound on the leading eigenvalue of B_hat[g].
+ * B_hat[g] = L_P - L_A, where L_A is the Laplacian of the group's inner graph, and L_P is the Laplacian of the
+ * complete graph of weights k_i * k_j / M, whose eigenvalues are at most K * max(k) / M.
+ * The algebraic connectivity of L_A is at least 2 * min(d) - n + 2 (Fiedler), so when that exceeds K * max(k) / M,
+ * B_hat[g] has no positive eigenvalue, and neither a vector nor a division of positive value.
+ */
+static int isIndivisibleNearClique(Graph *G, VerticesGroup *group, int *innerDegrees, double degreesSum) {
+    int i, minInnerDegree = innerDegrees[0];
+    double maxDegree = 0;
+    for (i = 0; i < group->size; i++) {
+        if (innerDegrees[i] < minInnerDegree) {
+            minInnerDegree = innerDegrees[i];
+        }
+        if (G->degrees[group->verticesArr[i]] > maxDegree) {
+            maxDegree = G->degrees[group->verticesArr[i]];
+        }
+    }
+    return degreesSum * maxDegree <= (double) (2 * minInnerDegree - group->size + 2) * G->degreeSum;
+}
+
+/**
+ * Check cheaply whether a group cannot be divided with a positive modularity.
+ * Covers single vertices, pairs, stars, and cliques or near-cliques.
+ * @param G graph object
+ * @param group vertices group, its vertices in increasing order
+ * @return 1 if the group is proven indivisible, 0 if it is unknown
+ */
+int isIndivisibleGroup(Graph *G, VerticesGroup *group) {
+    int *innerDegrees, i, result;
+    double degreesSum = 0;
+    if (group->size <= 1) {
+        return 1;
+    }
+
+    innerDegrees = malloc(group->size * sizeof(int));
+    assertMemoryAllocation(innerDegrees);
+    countInnerDegrees(G, group, innerDegrees);
+    for (i = 0; i < group->size; i++) {
+        degreesSum += G->degrees[group->verticesArr[i]];
+    }
+
+    if (group->size == 2) {
+        result = isIndivisiblePair(G, group, innerDegrees);
+    } else {
+        result = isIndivisibleStar(G, group, innerDegrees, degreesSum) ||
+                 isIndivisibleNearClique(G, group, innerDegrees, degreesSum);
+    }
+    free(innerDegrees);
+    return result;
+}
@@ -0,0 +1,15 @@
+#ifndef CLUSTER_INDIVISIBLE_H
+#define CLUSTER_INDIVISIBLE_H
+
+#include "graph.h"
+#include "VerticesGroup.h"
+
+/*
+ * Cheap tests which prove that a group has no division of positive modularity, before any sub matrix is built.
+ * Every test reads only the adjacency rows of the group's vertices, and is conservative:
+ * a group it reports is rejected by every engine as well, so skipping the solve does not change the division.
+ */
+
+int isIndivisibleGroup(Graph *G, VerticesGroup *group);
+
+#endif
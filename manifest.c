@@ -0,0 +1,205 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "manifest.h"
+#include "graph.h"
+#include "LinkedList.h"
+#include "output.h"
+#include "ErrorHandler.h"
+
+/* the integers before the index: the magic and the number of graphs */
+#define CONTAINER_HEADER_LENGTH 2
+
+typedef struct _manifestBatch {
+    char **paths;
+    int count;
+    DivisionSettings *settings;
+    ReorderMethod reorder;
+    int replay;
+    int sortVertices;
+    /* the division of every graph, NULL until its worker is done */
+    LinkedList **results;
+    /* the next graph for a worker to take */
+    int next;
+    pthread_mutex_t lock;
+    /* signaled whenever a division is done */
+    pthread_cond_t done;
+} ManifestBatch;
+
+/**
+ * Read the input paths of a manifest.
+ * @param manifestPath path of the manifest
+ * @param count will be assigned the number of paths
+ * @return the paths (each, and the array, to be freed by the caller)
+ */
+static char **readManifest(char *manifestPath, int *count) {
+    FILE *manifestFile = fopen(manifestPath, "r");
+    char line[MANIFEST_MAX_LINE], **paths;
+    int capacity = 16;
+    size_t length;
+    assertFileOpen(manifestFile, manifestPath);
+    paths = malloc(capacity * sizeof(char *));
+    assertMemoryAllocation(paths);
+    *count = 0;
+    while (fgets(line, MANIFEST_MAX_LINE, manifestFile) != NULL) {
+        length = strlen(line);
+        if (length == MANIFEST_MAX_LINE - 1 && line[length - 1] != '\n') {
+            throw("A line of the manifest is too long");
+        }
+        while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) {
+            line[--length] = '\0';
+        }
+        if (length == 0) {
+            continue;
+        }
+        if (*count == capacity) {
+            capacity *= 2;
+            paths = realloc(paths, capacity * sizeof(char *));
+            assertMemoryAllocation(paths);
+        }
+        paths[*count] = malloc(length + 1);
+        assertMemoryAllocation(paths[*count]);
+        strcpy(paths[(*count)++], line);
+    }
+    fclose(manifestFile);
+    return paths;
+}
+
+/**
+ * Load and divide the graphs of a manifest, until there are none left to take.
+ * @param argument the batch (a ManifestBatch)
+ * @return NULL
+ */
+static void *divideManifestGraphs(void *argument) {
+    ManifestBatch *batch = (ManifestBatch *) argument;
+    DivisionSettings settings = *batch->settings;
+    LinkedList *groupLst;
+    Graph *G;
+    int i;
+    for (;;) {
+        pthread_mutex_lock(&batch->lock);
+        i = batch->next++;
+        pthread_mutex_unlock(&batch->lock);
+        if (i >= batch->count) {
+            return NULL;
+        }
+
+        G = constructGraphFromInput(batch->paths[i]);
+        reorderGraph(G, batch->reorder);
+        groupLst = divisionAlgorithm(G, &settings);
+        if (G->originalIndices != NULL) {
+            restoreOriginalIndices(groupLst, G->originalIndices);
+        }
+        if (batch->replay) {
+            sortGroupList(groupLst);
+        }
+        if (batch->sortVertices) {
+            sortGroupVertices(groupLst);
+        }
+        destroyGraph(G);
+
+        pthread_mutex_lock(&batch->lock);
+        batch->results[i] = groupLst;
+        pthread_cond_broadcast(&batch->done);
+        pthread_mutex_unlock(&batch->lock);
+    }
+}
+
+/**
+ * Divide every graph of a manifest, and write the divisions into a container file.
+ * The divisions are written in the order of the manifest as soon as they and all the ones before them are done.
+ * @param manifestPath path of the manifest, listing the input files
+ * @param containerPath path of the container file
+ * @param settings division settings, shared by all the graphs
+ * @param reorder the relabeling of every graph after loading
+ * @param replay whether the groups are written in the canonical order of --replay
+ * @param sortVertices whether the vertices of every group are written in increasing order
+ * @param workers the number of worker threads, between 1 and MANIFEST_MAX_WORKERS
+ */
+void divideManifest(char *manifestPath, char *containerPath, DivisionSettings *settings, ReorderMethod reorder,
+                    int replay, int sortVertices, int workers) {
+    ManifestBatch batch;
+    pthread_t *threads;
+    FILE *containerFile;
+    unsigned int *index;
+    unsigned long position;
+    size_t length, capacity = 0;
+    int i, header[CONTAINER_HEADER_LENGTH], *buffer = NULL;
+    if (workers < 1 || workers > MANIFEST_MAX_WORKERS) {
+        throw("The number of workers should be between 1 and 256");
+    }
+    if (settings->checkpointPath != NULL || settings->resumePath != NULL || settings->dendrogram != NULL) {
+        throw("Checkpoints and dendrograms are not supported for a manifest");
+    }
+#ifdef CLUSTER_STATS
+    workers = 1;
+#endif
+
+    batch.paths = readManifest(manifestPath, &batch.count);
+    batch.settings = settings;
+    batch.reorder = reorder;
+    batch.replay = replay;
+    batch.sortVertices = sortVertices;
+    batch.results = calloc(batch.count > 0 ? batch.count : 1, sizeof(LinkedList *));
+    assertMemoryAllocation(batch.results);
+    batch.next = 0;
+    pthread_mutex_init(&batch.lock, NULL);
+    pthread_cond_init(&batch.done, NULL);
+    index = malloc((2 * batch.count + 1) * sizeof(unsigned int));
+    assertMemoryAllocation(index);
+    threads = malloc(workers * sizeof(pthread_t));
+    assertMemoryAllocation(threads);
+
+    containerFile = fopen(containerPath, "wb");
+    assertFileOpen(containerFile, containerPath);
+    header[0] = CONTAINER_MAGIC;
+    header[1] = batch.count;
+    assertFileWrite(fwrite(header, sizeof(int), CONTAINER_HEADER_LENGTH, containerFile), CONTAINER_HEADER_LENGTH,
+                    containerPath);
+    /* the index is written after the divisions, once their positions are known */
+    assertFileWrite(fseek(containerFile, 2 * batch.count * sizeof(int), SEEK_CUR), 0, containerPath);
+    position = CONTAINER_HEADER_LENGTH + 2 * (unsigned long) batch.count;
+
+    for (i = 0; i < workers; ++i) {
+        assertBooleanStatementIsTrue(pthread_create(&threads[i], NULL, divideManifestGraphs, &batch) == 0);
+    }
+    for (i = 0; i < batch.count; ++i) {
+        pthread_mutex_lock(&batch.lock);
+        while (batch.results[i] == NULL) {
+            pthread_cond_wait(&batch.done, &batch.lock);
+        }
+        pthread_mutex_unlock(&batch.lock);
+
+        length = getOutputLength(batch.results[i]);
+        if (length > capacity) {
+            capacity = length;
+            free(buffer);
+            buffer = malloc(capacity * sizeof(int));
+            assertMemoryAllocation(buffer);
+        }
+        fillOutputBuffer(batch.results[i], buffer);
+        assertFileWrite(fwrite(buffer, sizeof(int), length, containerFile), length, containerPath);
+        index[2 * i] = (unsigned int) (position & 0xffffffffUL);
+        /* shifted twice, as a shift by the width of a 32-bit long is undefined */
+        index[2 * i + 1] = (unsigned int) ((position >> 16) >> 16);
+        position += length;
+        deepFreeGroupList(batch.results[i]);
+        free(batch.paths[i]);
+    }
+    for (i = 0; i < workers; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    assertFileWrite(fseek(containerFile, CONTAINER_HEADER_LENGTH * sizeof(int), SEEK_SET), 0, containerPath);
+    assertFileWrite(fwrite(index, sizeof(int), 2 * batch.count, containerFile), 2 * batch.count, containerPath);
+    assertFileWrite(fclose(containerFile), 0, containerPath);
+
+    pthread_mutex_destroy(&batch.lock);
+    pthread_cond_destroy(&batch.done);
+    free(buffer);
+    free(threads);
+    free(index);
+    free(batch.results);
+    free(batch.paths);
+}
@@ -0,0 +1,31 @@
+#ifndef CLUSTER_MANIFEST_H
+#define CLUSTER_MANIFEST_H
+
+#include "division.h"
+#include "reorder.h"
+
+/* the first integer of a container file, identifies its format */
+#define CONTAINER_MAGIC 0x314e5443
+/* the longest line of a manifest, including its line break */
+#define MANIFEST_MAX_LINE 4096
+/* the most workers a manifest is divided by */
+#define MANIFEST_MAX_WORKERS 256
+
+/*
+ * Division of many graphs in one process: a manifest lists the input files, one path per line (empty lines are
+ * skipped), and all their divisions are written into a single container file.
+ * The graphs are loaded and divided by a pool of worker threads, each taking the next graph of the manifest once it is
+ * done with its last one, so the loading of some graphs overlaps the division of others. Every graph is divided
+ * with the same settings, as by a run of cluster on it alone.
+ * The container is a sequence of integers: CONTAINER_MAGIC, the number of graphs, an index of the low and high 32
+ * bits of the position (in integers, from the start of the file) of every graph's division, and then the divisions
+ * in the order of the manifest, each in the output file format. A division ends where the next one starts, or at the
+ * end of the file.
+ * In a CLUSTER_STATS build there is a single worker, as the statistics are process-wide, and they are summed over
+ * all the graphs.
+ */
+
+void divideManifest(char *manifestPath, char *containerPath, DivisionSettings *settings, ReorderMethod reorder,
+                    int replay, int sortVertices, int workers);
+
+#endif
@@ -0,0 +1,431 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "multiway.h"
+#include "dense.h"
+#include "indivisible.h"
+#include "defs.h"
+#include "ErrorHandler.h"
+#include "stats.h"
+
+/**
+ * Orthonormalize vectors by the modified Gram-Schmidt process, dropping the vectors which depend on the previous.
+ * @param vectors count arrays of n items, one after the other. The kept vectors are moved to the front
+ * @param count the number of vectors
+ * @param n the dimension
+ * @return the number of vectors kept
+ */
+static int orthonormalize(double *vectors, int count, int n) {
+    int i, j, k, kept = 0;
+    double dot, norm, original;
+    double *v;
+    for (j = 0; j < count; j++) {
+        v = vectors + kept * n;
+        if (kept != j) {
+            memmove(v, vectors + j * n, n * sizeof(double));
+        }
+        original = 0;
+        for (i = 0; i < n; i++) {
+            original += v[i] * v[i];
+        }
+        for (k = 0; k < kept; k++) {
+            dot = 0;
+            for (i = 0; i < n; i++) {
+                dot += vectors[k * n + i] * v[i];
+            }
+            for (i = 0; i < n; i++) {
+                v[i] -= dot * vectors[k * n + i];
+            }
+        }
+        norm = 0;
+        for (i = 0; i < n; i++) {
+            norm += v[i] * v[i];
+        }
+        if (IS_POSITIVE(sqrt(norm / original))) {
+            norm = sqrt(norm);
+            for (i = 0; i < n; i++) {
+                v[i] /= norm;
+            }
+            kept++;
+        }
+    }
+    return kept;
+}
+
+/**
+ * Find the leading eigenpairs of B_hat[g] by a block power iteration, shifted by the 1-norm as in powerIteration.
+ * Every step multiplies the vectors by the shifted matrix, rotates them by the eigenvectors of their projection
+ * (Rayleigh-Ritz) and orthonormalizes the products. The leading Ritz vector converges faster than the vector of
+ * powerIteration, and the iteration stops once its residual is below epsilon (relative to the shifted eigenvalue),
+ * leaving the other vectors less polished, as the refinement follows anyway.
+ * @param G graph object
+ * @param group a vertices group, containing the modularity sub matrix
+ * @param vectors p arrays of the group's size one after the other, the initial vectors.
+ * Will be assigned the unit Ritz vectors, in decreasing order of their values
+ * @param p the number of eigenpairs to find
+ * @param eigenvalues an allocated array of p items, will be assigned the Ritz values (of the un-shifted B_hat)
+ * @return the number of eigenpairs found, less than p if the vectors turned dependent
+ */
+static int blockPowerIteration(Graph *G, VerticesGroup *group, double *vectors, int p, double *eigenvalues) {
+    int i, j, k, iteration, con = 1, leading, n = group->size, *order;
+    double norm1 = getModularityMatrixNorm1(group), u, product, *H, *ritz, *products;
+    products = malloc(p * n * sizeof(double));
+    assertMemoryAllocation(products);
+    H = malloc(p * p * sizeof(double));
+    assertMemoryAllocation(H);
+    ritz = malloc(p * sizeof(double));
+    assertMemoryAllocation(ritz);
+    order = malloc(p * sizeof(int));
+    assertMemoryAllocation(order);
+
+    p = orthonormalize(vectors, p, n);
+    for (iteration = 0; p > 0; iteration++) {
+        STATS_COUNT(STATS_COUNTER_POWER_ITERATIONS, group->depth, 1);
+        for (j = 0; j < p; j++) {
+            multiplyModularityByVector(G, group, vectors + j * n, products + j * n, 0, 1, 1);
+        }
+        /* the projection of the products on the subspace, symmetrized */
+        for (j = 0; j < p; j++) {
+            for (k = 0; k <= j; k++) {
+                H[j * p + k] = 0;
+                for (i = 0; i < n; i++) {
+                    H[j * p + k] += vectors[j * n + i] * products[k * n + i] +
+                                    vectors[k * n + i] * products[j * n + i];
+                }
+                H[j * p + k] /= 2;
+                H[k * p + j] = H[j * p + k];
+            }
+        }
+        denseEigenpairs(H, p, ritz);
+        leading = 0;
+        for (j = 1; j < p; j++) {
+            if (ritz[j] > ritz[leading]) {
+                leading = j;
+            }
+        }
+        con = 0;
+        for (i = 0; i < n && !con; i++) {
+            u = 0;
+            product = 0;
+            for (j = 0; j < p; j++) {
+                u += vectors[j * n + i] * H[j * p + leading];
+                product += products[j * n + i] * H[j * p + leading];
+            }
+            if (IS_POSITIVE(fabs(product - ritz[leading] * u) / ritz[leading])) {
+                con = 1;
+            }
+        }
+        if (!con || iteration + 1 == MULTIWAY_MAX_ITERATIONS) {
+            break;
+        }
+        memcpy(vectors, products, p * n * sizeof(double));
+        p = orthonormalize(vectors, p, n);
+    }
+
+    if (p > 0) {
+        /* order the Ritz pairs by decreasing value */
+        for (j = 0; j < p; j++) {
+            order[j] = j;
+        }
+        for (j = 0; j < p; j++) {
+            leading = j;
+            for (k = j + 1; k < p; k++) {
+                if (ritz[order[k]] > ritz[order[leading]]) {
+                    leading = k;
+                }
+            }
+            k = order[j];
+            order[j] = order[leading];
+            order[leading] = k;
+        }
+        for (j = 0; j < p; j++) {
+            eigenvalues[j] = ritz[order[j]] - norm1;
+            for (i = 0; i < n; i++) {
+                products[j * n + i] = 0;
+                for (k = 0; k < p; k++) {
+                    products[j * n + i] += vectors[k * n + i] * H[k * p + order[j]];
+                }
+            }
+        }
+        memcpy(vectors, products, p * n * sizeof(double));
+    }
+
+    free(products);
+    free(H);
+    free(ritz);
+    free(order);
+    return p;
+}
+
+/**
+ * Partition the vertices by the directions of their vectors in the spectral embedding.
+ * Every vertex starts in the part of its largest coordinate and that coordinate's sign, and is then moved to the
+ * part whose sum vector R_c is the closest to its own, until no vertex moves.
+ * @param vectors q scaled eigenvectors of n items one after the other, vertex i is at (vectors[j * n + i])
+ * @param q the dimension of the embedding
+ * @param n the number of vertices
+ * @param labels an allocated array of n items, will be assigned the parts of the vertices, between 0 and 2q-1
+ */
+static void partitionVertices(double *vectors, int q, int n, int *labels) {
+    int i, j, c, round, best, changed = 1;
+    double value, bestValue = 0;
+    double *directions = malloc(2 * q * q * sizeof(double));
+    assertMemoryAllocation(directions);
+
+    for (i = 0; i < n; i++) {
+        best = 0;
+        for (j = 1; j < q; j++) {
+            if (fabs(vectors[j * n + i]) > fabs(vectors[best * n + i])) {
+                best = j;
+            }
+        }
+        labels[i] = 2 * best + (vectors[best * n + i] < 0);
+    }
+
+    for (round = 0; changed && round < MULTIWAY_PARTITION_ROUNDS; round++) {
+        for (c = 0; c < 2 * q * q; c++) {
+            directions[c] = 0;
+        }
+        for (i = 0; i < n; i++) {
+            for (j = 0; j < q; j++) {
+                directions[labels[i] * q + j] += vectors[j * n + i];
+            }
+        }
+        changed = 0;
+        for (i = 0; i < n; i++) {
+            best = -1;
+            for (c = 0; c < 2 * q; c++) {
+                value = 0;
+                for (j = 0; j < q; j++) {
+                    value += directions[c * q + j] * vectors[j * n + i];
+                }
+                if (best == -1 || value > bestValue) {
+                    best = c;
+                    bestValue = value;
+                }
+            }
+            if (best != labels[i]) {
+                labels[i] = best;
+                changed = 1;
+            }
+        }
+    }
+    free(directions);
+}
+
+/**
+ * Maximize modularity by moving vertices between the parts of a multi-way division.
+ * Every pass moves each vertex once, choosing every time the move of the largest gain, and keeps the best prefix
+ * of the moves, like maximizeModularity. Moving vertex i from part a to part b changes the modularity by
+ * 2 * (e_ib - e_ia) - 2 * k_i * (K_b - K_a + k_i) / M, where e_ic counts the neighbors of i in part c, and K_c sums
+ * the degrees of part c.
+ * @param G graph object
+ * @param group a group of vertices
+ * @param offsets the first neighbor of every vertex, as assigned by listInnerNeighbors
+ * @param neighbors the positions of the inner neighbors, as returned by listInnerNeighbors
+ * @param labels the parts of the vertices, between 0 and partsCount-1, will be assigned the refined division
+ * @param partsCount the number of parts
+ * @return the modularity delta of the division (in the units of calculateModularity)
+ */
+double multiwayMaximizeModularity(Graph *G, VerticesGroup *group, int *offsets, int *neighbors, int *labels,
+                                  int partsCount) {
+    int n = group->size, i, k, a, b, c, iteration, maxNode = 0, maxTarget = 0, bestIteration, isMaxSet, inner;
+    int *edges, *indices, *origins;
+    char *hasMoved;
+    double *degreeSums, gain, maxGain = 0, improve, bestImprovement, degree, squares, total;
+
+    edges = malloc(n * partsCount * sizeof(int));
+    assertMemoryAllocation(edges);
+    indices = malloc(n * sizeof(int));
+    assertMemoryAllocation(indices);
+    origins = malloc(n * sizeof(int));
+    assertMemoryAllocation(origins);
+    hasMoved = calloc(n, sizeof(char));
+    assertMemoryAllocation(hasMoved);
+    degreeSums = malloc(partsCount * sizeof(double));
+    assertMemoryAllocation(degreeSums);
+
+    do {
+        STATS_COUNT(STATS_COUNTER_REFINEMENT_PASSES, group->depth, 1);
+        for (c = 0; c < partsCount; c++) {
+            degreeSums[c] = 0;
+        }
+        for (i = 0; i < n; i++) {
+            degreeSums[labels[i]] += G->degrees[group->verticesArr[i]];
+            for (c = 0; c < partsCount; c++) {
+                edges[i * partsCount + c] = 0;
+            }
+            for (k = offsets[i]; k < offsets[i + 1]; k++) {
+                edges[i * partsCount + labels[neighbors[k]]]++;
+            }
+        }
+
+        improve = 0;
+        bestImprovement = 0;
+        bestIteration = -1;
+        for (iteration = 0; iteration < n; iteration++) {
+            isMaxSet = 0;
+            for (i = 0; i < n; i++) {
+                if (!hasMoved[i]) {
+                    a = labels[i];
+                    degree = G->degrees[group->verticesArr[i]];
+                    for (b = 0; b < partsCount; b++) {
+                        if (b == a) {
+                            continue;
+                        }
+                        gain = 2 * (edges[i * partsCount + b] - edges[i * partsCount + a]) -
+                               2 * degree * (degreeSums[b] - degreeSums[a] + degree) / G->degreeSum;
+                        if (!isMaxSet || gain > maxGain) {
+                            maxGain = gain;
+                            maxNode = i;
+                            maxTarget = b;
+                            isMaxSet = 1;
+                        }
+                    }
+                }
+            }
+            a = labels[maxNode];
+            origins[iteration] = a;
+            labels[maxNode] = maxTarget;
+            degreeSums[a] -= G->degrees[group->verticesArr[maxNode]];
+            degreeSums[maxTarget] += G->degrees[group->verticesArr[maxNode]];
+            for (k = offsets[maxNode]; k < offsets[maxNode + 1]; k++) {
+                edges[neighbors[k] * partsCount + a]--;
+                edges[neighbors[k] * partsCount + maxTarget]++;
+            }
+            hasMoved[maxNode] = 1;
+            indices[iteration] = maxNode;
+
+            improve += maxGain;
+            if (bestIteration == -1 || improve > bestImprovement) {
+                bestIteration = iteration;
+                bestImprovement = improve;
+            }
+        }
+
+        /* undo the moves after the best prefix, every vertex moved once */
+        for (iteration = 0; iteration < n; iteration++) {
+            hasMoved[iteration] = 0;
+            if (iteration > bestIteration) {
+                labels[indices[iteration]] = origins[iteration];
+            }
+        }
+    } while (IS_POSITIVE(bestImprovement));
+
+    /* sum of B_ij over the pairs inside the parts, less the sum over all the pairs of the group */
+    for (c = 0; c < partsCount; c++) {
+        degreeSums[c] = 0;
+    }
+    inner = 0;
+    for (i = 0; i < n; i++) {
+        degreeSums[labels[i]] += G->degrees[group->verticesArr[i]];
+        for (k = offsets[i]; k < offsets[i + 1]; k++) {
+            inner += labels[neighbors[k]] == labels[i];
+        }
+    }
+    squares = 0;
+    total = 0;
+    for (c = 0; c < partsCount; c++) {
+        squares += degreeSums[c] * degreeSums[c];
+        total += degreeSums[c];
+    }
+
+    free(edges);
+    free(indices);
+    free(origins);
+    free(hasMoved);
+    free(degreeSums);
+    return (inner - offsets[n]) - (squares - total * total) / G->degreeSum;
+}
+
+/**
+ * Divide a group of the sparse engine into several parts, by several leading eigenvectors.
+ * @param G graph object
+ * @param settings division settings, settings->splitVectors eigenvectors are used
+ * @param group vertices group, its vertices in increasing order
+ * @param s an empty allocated array the capacity of the graph's vertices, used for a bisection
+ * @param parts an allocated array of capacity 2 * settings->splitVectors, will be assigned the parts
+ * @return the number of parts, 0 if the group is indivisible
+ */
+int multiwayDivisionAlgorithm(Graph *G, DivisionSettings *settings, VerticesGroup *group, double *s,
+                              VerticesGroup **parts) {
+    int i, j, p, q, partsCount, count = 0, n = group->size, *labels, *offsets, *neighbors, *sizes;
+    double eigenvalues[MULTIWAY_MAX_VECTORS], lambda = 0, modularity, *vectors;
+    Rng rng;
+
+    parts[0] = NULL;
+    parts[1] = NULL;
+    STATS_COUNT(STATS_COUNTER_GROUPS, group->depth, 1);
+    if (settings->preChecks && isIndivisibleGroup(G, group)) {
+        STATS_COUNT(STATS_COUNTER_REJECTED_PRECHECK, group->depth, 1);
+        return 0;
+    }
+    calculateSparseSubMatrix(G, settings, group);
+
+    STATS_START(STATS_PHASE_EIGEN);
+    p = settings->splitVectors < n ? settings->splitVectors : n;
+    vectors = malloc(p * n * sizeof(double));
+    assertMemoryAllocation(vectors);
+    /* the first vector is the start vector of divisionAlgorithm2 */
+    seedRng(&rng, settings->seed, group->verticesArr[0], group->size);
+    randVector(vectors, p * n, &rng);
+    p = blockPowerIteration(G, group, vectors, p, eigenvalues);
+    STATS_STOP(STATS_PHASE_EIGEN, group->depth);
+    if (p > 0) {
+        lambda = eigenvalues[0];
+        memcpy(s, vectors, n * sizeof(double));
+    }
+    for (q = 0; q < p && IS_POSITIVE(eigenvalues[q]); q++);
+
+    if (q >= 2) {
+        STATS_START(STATS_PHASE_REFINEMENT);
+        for (j = 0; j < q; j++) {
+            for (i = 0; i < n; i++) {
+                vectors[j * n + i] *= sqrt(eigenvalues[j]);
+            }
+        }
+        labels = malloc(n * sizeof(int));
+        assertMemoryAllocation(labels);
+        partitionVertices(vectors, q, n, labels);
+        offsets = malloc((n + 1) * sizeof(int));
+        assertMemoryAllocation(offsets);
+        neighbors = listInnerNeighbors(G, group, offsets);
+        partsCount = 2 * q;
+        modularity = multiwayMaximizeModularity(G, group, offsets, neighbors, labels, partsCount);
+        free(offsets);
+        free(neighbors);
+        STATS_STOP(STATS_PHASE_REFINEMENT, group->depth);
+
+        if (IS_POSITIVE(modularity)) {
+            STATS_COUNT(STATS_COUNTER_SPLITS_ACCEPTED, group->depth, 1);
+            sizes = calloc(partsCount, sizeof(int));
+            assertMemoryAllocation(sizes);
+            for (i = 0; i < n; i++) {
+                sizes[labels[i]]++;
+            }
+            /* the labels of the non-empty parts are replaced by their indices in parts */
+            for (j = 0; j < partsCount; j++) {
+                if (sizes[j] > 0) {
+                    parts[count] = createVerticesGroup(sizes[j]);
+                    parts[count]->depth = group->depth + 1;
+                    sizes[j] = count++;
+                }
+            }
+            /* vertices are added in increasing order, as the division algorithm expects */
+            for (i = 0; i < n; i++) {
+                addVertexToGroup(parts[sizes[labels[i]]], group->verticesArr[i]);
+            }
+            free(sizes);
+            free(labels);
+            free(vectors);
+            freeVerticesGroupModularitySubMatrix(group);
+            return count;
+        }
+        free(labels);
+    }
+
+    /* at most one positive eigenvalue, or no better multi-way division: bisect by the leading eigenvector */
+    free(vectors);
+    divideByLeadingEigenvector(G, group, lambda, s, &parts[0], &parts[1]);
+    return parts[0] != NULL && parts[1] != NULL ? 2 : 0;
+}
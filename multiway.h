@@ -0,0 +1,32 @@
+#ifndef CLUSTER_MULTIWAY_H
+#define CLUSTER_MULTIWAY_H
+
+#include "graph.h"
+#include "VerticesGroup.h"
+#include "division.h"
+
+/* at most this many leading eigenvectors divide a group at once */
+#define MULTIWAY_MAX_VECTORS 8
+/* steps of the block power iteration allowed before its subspace is used as it is */
+#define MULTIWAY_MAX_ITERATIONS 10000
+/* rounds of vector partitioning before the refinement */
+#define MULTIWAY_PARTITION_ROUNDS 10
+
+/*
+ * Multi-way division of a group by several leading eigenvectors of B_hat[g].
+ * A block power iteration finds the p leading eigenpairs together, and every vertex i is given the vector
+ * r_i = (sqrt(beta_j) * u_j[i]) over the positive eigenvalues beta_j. The modularity of a division is then about
+ * the sum of |R_c|^2 over its parts, where R_c sums the vectors of part c, so the vertices are partitioned by the
+ * directions of their vectors, into up to twice as many parts as positive eigenvalues. The division is refined by
+ * moving single vertices between the parts, as maximizeModularity does between two.
+ * When at most one eigenvalue is positive, or the multi-way division does not increase the modularity, the group
+ * is bisected by its leading eigenvector instead.
+ */
+
+double multiwayMaximizeModularity(Graph *G, VerticesGroup *group, int *offsets, int *neighbors, int *labels,
+                                  int partsCount);
+
+int multiwayDivisionAlgorithm(Graph *G, DivisionSettings *settings, VerticesGroup *group, double *s,
+                              VerticesGroup **parts);
+
+#endif
@@ -0,0 +1,147 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "output.h"
+#include "ErrorHandler.h"
+
+static int compareVertices(const void *a, const void *b) {
+    int x = *(const int *) a, y = *(const int *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Sort the vertices of every group in a list in increasing order.
+ * @param groupLst list of vertices groups
+ */
+void sortGroupVertices(LinkedList *groupLst) {
+    LinkedListNode *currentNode = groupLst->first;
+    VerticesGroup *currentGroup;
+    int i;
+    for (i = 0; i < groupLst->length; ++i) {
+        currentGroup = currentNode->pointer;
+        qsort(currentGroup->verticesArr, currentGroup->size, sizeof(int), compareVertices);
+        currentNode = currentNode->next;
+    }
+}
+
+/**
+ * Map the vertices of every group in a list back to their indices in the input, after the graph was relabeled.
+ * The vertices of every group are then sorted in increasing order again.
+ * @param groupLst list of vertices groups
+ * @param originalIndices originalIndices[v] is the input index of vertex v (see Graph).
+ */
+void restoreOriginalIndices(LinkedList *groupLst, int *originalIndices) {
+    LinkedListNode *currentNode = groupLst->first;
+    VerticesGroup *currentGroup;
+    int i, j;
+    for (i = 0; i < groupLst->length; ++i) {
+        currentGroup = currentNode->pointer;
+        for (j = 0; j < currentGroup->size; ++j) {
+            currentGroup->verticesArr[j] = originalIndices[currentGroup->verticesArr[j]];
+        }
+        currentNode = currentNode->next;
+    }
+    sortGroupVertices(groupLst);
+}
+
+/**
+ * Calculate the number of integers in the output file of a division
+ * @param groupLst list of vertices groups
+ * @return the number of integers: the number of groups, and the size and vertices of every group.
+ */
+size_t getOutputLength(LinkedList *groupLst) {
+    LinkedListNode *currentNode = groupLst->first;
+    size_t length = 1 + groupLst->length;
+    int i;
+    for (i = 0; i < groupLst->length; ++i) {
+        length += ((VerticesGroup *) currentNode->pointer)->size;
+        currentNode = currentNode->next;
+    }
+    return length;
+}
+
+/**
+ * Serialize a division into a buffer, in the output file format.
+ * The fill is sequential: the offset of every group is only known by walking the list up to it, and that walk takes
+ * most of the fill's time, so threads would only share the copying of the vertices.
+ * @param groupLst list of vertices groups
+ * @param buffer a buffer of getOutputLength(groupLst) integers
+ */
+void fillOutputBuffer(LinkedList *groupLst, int *buffer) {
+    LinkedListNode *currentNode = groupLst->first;
+    VerticesGroup *currentGroup;
+    int i, j;
+    *(buffer++) = groupLst->length;
+    for (i = 0; i < groupLst->length; ++i) {
+        currentGroup = currentNode->pointer;
+        *(buffer++) = currentGroup->size;
+        for (j = 0; j < currentGroup->size; ++j) {
+            *(buffer++) = currentGroup->verticesArr[j];
+        }
+        currentNode = currentNode->next;
+    }
+}
+
+/**
+ * Serialize a division directly into a memory mapping of the output file
+ * @param groupLst list of vertices groups
+ * @param output_path path of output file
+ * @param length the number of integers in the output
+ * @return 1 if the file was written, 0 if it could not be opened or mapped.
+ */
+static int saveOutputToMappedFile(LinkedList *groupLst, char *output_path, size_t length) {
+    int fd = open(output_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    size_t bytes = length * sizeof(int);
+    void *mapping;
+    if (fd < 0) {
+        return 0;
+    }
+    if (ftruncate(fd, bytes) != 0) {
+        close(fd);
+        return 0;
+    }
+    mapping = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        assertFileWrite(ftruncate(fd, 0), 0, output_path);
+        close(fd);
+        return 0;
+    }
+    fillOutputBuffer(groupLst, mapping);
+    assertFileWrite(munmap(mapping, bytes), 0, output_path);
+    assertFileWrite(close(fd), 0, output_path);
+    return 1;
+}
+
+/**
+ * Save the list of sub groups to an output file.
+ * The exact file size is computed in advance, and the whole file is serialized into a single buffer
+ * (or directly into a memory mapping of the file), which is written at once.
+ * @param groupLst list of vertices groups
+ * @param output_path path of output file
+ * @param sortVertices if set, the vertices of every group are sorted in increasing order first
+ * @param useMmap if set, the file is written through a memory mapping
+ */
+void saveOutputToFile(LinkedList *groupLst, char *output_path, int sortVertices, int useMmap) {
+    size_t length = getOutputLength(groupLst);
+    FILE *output_file;
+    int *buffer;
+    if (sortVertices) {
+        sortGroupVertices(groupLst);
+    }
+    if (useMmap && saveOutputToMappedFile(groupLst, output_path, length)) {
+        return;
+    }
+    /* fall back to a regular write, which also reports a file that cannot be opened */
+    buffer = malloc(length * sizeof(int));
+    assertMemoryAllocation(buffer);
+    fillOutputBuffer(groupLst, buffer);
+    output_file = fopen(output_path, "wb");
+    assertFileOpen(output_file, output_path);
+    assertFileWrite(fwrite(buffer, sizeof(int), length, output_file), length, output_path);
+    assertFileWrite(fclose(output_file), 0, output_path);
+    free(buffer);
+}
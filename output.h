@@ -0,0 +1,17 @@
+#ifndef CLUSTER_OUTPUT_H
+#define CLUSTER_OUTPUT_H
+
+#include <stddef.h>
+#include "LinkedList.h"
+
+void sortGroupVertices(LinkedList *groupLst);
+
+void restoreOriginalIndices(LinkedList *groupLst, int *originalIndices);
+
+size_t getOutputLength(LinkedList *groupLst);
+
+void fillOutputBuffer(LinkedList *groupLst, int *buffer);
+
+void saveOutputToFile(LinkedList *groupLst, char *output_path, int sortVertices, int useMmap);
+
+#endif
@@ -0,0 +1,183 @@
+#include <stdlib.h>
+#include <string.h>
+#include "reorder.h"
+#include "ErrorHandler.h"
+
+typedef struct _degreeVertex {
+    int degree;
+    int vertex;
+} DegreeVertex;
+
+/**
+ * Order vertices by increasing degree, and then by increasing index.
+ */
+static int compareIncreasingDegree(const void *a, const void *b) {
+    const DegreeVertex *x = a, *y = b;
+    if (x->degree != y->degree)
+        return (x->degree > y->degree) - (x->degree < y->degree);
+    return (x->vertex > y->vertex) - (x->vertex < y->vertex);
+}
+
+/**
+ * Order vertices by decreasing degree, and then by increasing index.
+ */
+static int compareDecreasingDegree(const void *a, const void *b) {
+    const DegreeVertex *x = a, *y = b;
+    if (x->degree != y->degree)
+        return (x->degree < y->degree) - (x->degree > y->degree);
+    return (x->vertex > y->vertex) - (x->vertex < y->vertex);
+}
+
+/**
+ * Get a reordering method by its command line name.
+ * @param name "none", "degree" or "rcm".
+ * @return the method.
+ */
+ReorderMethod parseReorderMethod(char *name) {
+    if (strcmp(name, "none") == 0)
+        return REORDER_NONE;
+    if (strcmp(name, "degree") == 0)
+        return REORDER_DEGREE;
+    if (strcmp(name, "rcm") == 0)
+        return REORDER_RCM;
+    throw("Unknown reordering method, expected one of: none, degree, rcm");
+    return REORDER_NONE;
+}
+
+/**
+ * Compute the decreasing-degree order of the vertices.
+ * @param G graph object
+ * @param order an array of G->n items, order[i] will be the vertex placed at position i.
+ */
+static void computeDegreeOrder(Graph *G, int *order) {
+    DegreeVertex *vertices = malloc(G->n * sizeof(DegreeVertex));
+    int i;
+    assertMemoryAllocation(vertices);
+    for (i = 0; i < G->n; ++i) {
+        vertices[i].degree = G->degrees[i];
+        vertices[i].vertex = i;
+    }
+    qsort(vertices, G->n, sizeof(DegreeVertex), compareDecreasingDegree);
+    for (i = 0; i < G->n; ++i) {
+        order[i] = vertices[i].vertex;
+    }
+    free(vertices);
+}
+
+/**
+ * Compute the reverse Cuthill-McKee order of the vertices.
+ * Every connected component is traversed by BFS, starting from its lowest degree vertex,
+ * and visiting the neighbors of every vertex by increasing degree. The order is then reversed.
+ * @param G graph object
+ * @param order an array of G->n items, order[i] will be the vertex placed at position i.
+ */
+static void computeRcmOrder(Graph *G, int *order) {
+    nodeRef *rows = (nodeRef *) G->adjMat->private;
+    nodeRef neighbor;
+    DegreeVertex *byDegree = malloc(G->n * sizeof(DegreeVertex));
+    DegreeVertex *neighbors = malloc(G->n * sizeof(DegreeVertex));
+    char *visited = calloc(G->n, sizeof(char));
+    int i, start, head = 0, tail = 0, count, v, temp;
+    assertMemoryAllocation(byDegree);
+    assertMemoryAllocation(neighbors);
+    assertMemoryAllocation(visited);
+
+    for (i = 0; i < G->n; ++i) {
+        byDegree[i].degree = G->degrees[i];
+        byDegree[i].vertex = i;
+    }
+    qsort(byDegree, G->n, sizeof(DegreeVertex), compareIncreasingDegree);
+
+    /* 'order' doubles as the BFS queue */
+    for (start = 0; start < G->n; ++start) {
+        if (visited[byDegree[start].vertex])
+            continue;
+        visited[byDegree[start].vertex] = 1;
+        order[tail++] = byDegree[start].vertex;
+        while (head < tail) {
+            v = order[head++];
+            count = 0;
+            for (neighbor = rows[v]; neighbor != NULL; neighbor = neighbor->next) {
+                if (!visited[neighbor->colind]) {
+                    visited[neighbor->colind] = 1;
+                    neighbors[count].degree = G->degrees[neighbor->colind];
+                    neighbors[count].vertex = neighbor->colind;
+                    ++count;
+                }
+            }
+            qsort(neighbors, count, sizeof(DegreeVertex), compareIncreasingDegree);
+            for (i = 0; i < count; ++i) {
+                order[tail++] = neighbors[i].vertex;
+            }
+        }
+    }
+
+    for (i = 0; i < G->n / 2; ++i) {
+        temp = order[i];
+        order[i] = order[G->n - 1 - i];
+        order[G->n - 1 - i] = temp;
+    }
+
+    free(visited);
+    free(neighbors);
+    free(byDegree);
+}
+
+/**
+ * Relabel the vertices of a graph, to improve the memory locality of the division algorithm.
+ * The adjacency matrix and the degrees are rebuilt in the new order, and G->originalIndices maps every
+ * new index back to the index of the vertex in the input.
+ * @param G graph object, which was not relabeled before
+ * @param method reordering method
+ */
+void reorderGraph(Graph *G, ReorderMethod method) {
+    nodeRef *rows = (nodeRef *) G->adjMat->private;
+    nodeRef neighbor;
+    spmat *adjMat;
+    int *order, *newIndices, *degrees;
+    double *row;
+    int i;
+
+    if (method == REORDER_NONE) {
+        return;
+    }
+    assertBooleanStatementIsTrue(G->originalIndices == NULL);
+    order = malloc(G->n * sizeof(int));
+    newIndices = malloc(G->n * sizeof(int));
+    degrees = malloc(G->n * sizeof(int));
+    row = calloc(G->n, sizeof(double));
+    assertMemoryAllocation(order);
+    assertMemoryAllocation(newIndices);
+    assertMemoryAllocation(degrees);
+    assertMemoryAllocation(row);
+
+    if (method == REORDER_DEGREE) {
+        computeDegreeOrder(G, order);
+    } else {
+        computeRcmOrder(G, order);
+    }
+    for (i = 0; i < G->n; ++i) {
+        newIndices[order[i]] = i;
+    }
+
+    adjMat = spmat_allocate_list(G->n);
+    for (i = 0; i < G->n; ++i) {
+        degrees[i] = G->degrees[order[i]];
+        for (neighbor = rows[order[i]]; neighbor != NULL; neighbor = neighbor->next) {
+            row[newIndices[neighbor->colind]] = neighbor->value;
+        }
+        adjMat->add_row(adjMat, row, i);
+        for (neighbor = rows[order[i]]; neighbor != NULL; neighbor = neighbor->next) {
+            row[newIndices[neighbor->colind]] = 0;
+        }
+    }
+
+    G->adjMat->free(G->adjMat);
+    free(G->degrees);
+    G->adjMat = adjMat;
+    G->degrees = degrees;
+    G->originalIndices = order;
+
+    free(row);
+    free(newIndices);
+}
@@ -0,0 +1,19 @@
+#ifndef CLUSTER_REORDER_H
+#define CLUSTER_REORDER_H
+
+#include "graph.h"
+
+typedef enum _reorderMethod {
+    /* keep the order of the input file */
+    REORDER_NONE,
+    /* decreasing degree, so the rows of the hubs are next to each other */
+    REORDER_DEGREE,
+    /* reverse Cuthill-McKee, which keeps the neighbors of a vertex close to it */
+    REORDER_RCM
+} ReorderMethod;
+
+ReorderMethod parseReorderMethod(char *name);
+
+void reorderGraph(Graph *G, ReorderMethod method);
+
+#endif
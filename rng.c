@@ -0,0 +1,51 @@
+#include "rng.h"
+
+#define RNG_MASK 0xFFFFFFFFUL
+#define RNG_INCREMENT 0x9E3779B9UL
+
+/**
+ * Scramble a 32-bit value (the finalizer of MurmurHash3).
+ * @param z a value
+ * @return the scrambled value
+ */
+static unsigned long mix(unsigned long z) {
+    z &= RNG_MASK;
+    z = ((z ^ (z >> 16)) * 0x85EBCA6BUL) & RNG_MASK;
+    z = ((z ^ (z >> 13)) * 0xC2B2AE35UL) & RNG_MASK;
+    return z ^ (z >> 16);
+}
+
+/**
+ * Initialize a generator.
+ * @param rng the generator
+ * @param seed the seed of the whole run, all of whose bits are used
+ * @param key1 first component of the key of the object the generator is used for
+ * @param key2 second component of the key of the object the generator is used for
+ */
+void seedRng(Rng *rng, unsigned long seed, unsigned long key1, unsigned long key2) {
+    /* the high half of a 64-bit seed is folded in, shifted twice as a shift by the width of a 32-bit long is
+     * undefined; mix(0) is 0, so seeds of 32 bits keep their sequences */
+    unsigned long state = mix(seed + RNG_INCREMENT) ^ mix((seed >> 16) >> 16);
+    state = mix(state ^ (key1 & RNG_MASK)) + RNG_INCREMENT;
+    state = mix(state ^ (key2 & RNG_MASK));
+    rng->state = state;
+}
+
+/**
+ * Draw the next number of a generator.
+ * @param rng the generator
+ * @return a number in [0, 2^32)
+ */
+unsigned long nextRandom(Rng *rng) {
+    rng->state = (rng->state + RNG_INCREMENT) & RNG_MASK;
+    return mix(rng->state);
+}
+
+/**
+ * Draw the next number of a generator, as a double.
+ * @param rng the generator
+ * @return a number in [0, 1)
+ */
+double nextRandomDouble(Rng *rng) {
+    return (double) nextRandom(rng) / 4294967296.0;
+}
@@ -0,0 +1,20 @@
+#ifndef CLUSTER_RNG_H
+#define CLUSTER_RNG_H
+
+/*
+ * A small counter-based pseudo random generator (a 32-bit splitmix variant).
+ * Every generator is keyed by a seed and by the object it is used for, so its sequence does not
+ * depend on what was drawn before, or on the order in which objects are processed.
+ * Unlike rand(), it holds no global state.
+ */
+typedef struct _rng {
+    unsigned long state;
+} Rng;
+
+void seedRng(Rng *rng, unsigned long seed, unsigned long key1, unsigned long key2);
+
+unsigned long nextRandom(Rng *rng);
+
+double nextRandomDouble(Rng *rng);
+
+#endif
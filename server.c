@@ -0,0 +1,388 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "server.h"
+#include "VerticesGroup.h"
+#include "LinkedList.h"
+#include "division.h"
+#include "output.h"
+#include "ErrorHandler.h"
+
+/* the most connections served at once, one in a CLUSTER_STATS build as the statistics are process-wide */
+#ifdef CLUSTER_STATS
+#define SERVER_MAX_CONNECTIONS 1
+#else
+#define SERVER_MAX_CONNECTIONS 64
+#endif
+
+typedef struct _server {
+    int listener;
+    ResidentGraph *graphs;
+    int graphsCount;
+    /* cleared by a SERVER_SHUTDOWN request */
+    int running;
+    /* the number of connections being served */
+    int connections;
+    pthread_mutex_t lock;
+    /* signaled whenever a connection is done */
+    pthread_cond_t done;
+} Server;
+
+typedef struct _serverConnection {
+    Server *server;
+    int connection;
+} ServerConnection;
+
+static int compareInts(const void *a, const void *b) {
+    int x = *(const int *) a, y = *(const int *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Read exactly a given number of bytes from a connection.
+ * @param connection the connection's socket
+ * @param buffer a buffer of the given number of bytes
+ * @param bytes the number of bytes to read
+ * @return 1 if all the bytes were read, 0 if the connection was closed or failed first.
+ */
+static int readAll(int connection, void *buffer, size_t bytes) {
+    char *position = buffer;
+    ssize_t count;
+    while (bytes > 0) {
+        count = read(connection, position, bytes);
+        if (count <= 0) {
+            return 0;
+        }
+        position += count;
+        bytes -= (size_t) count;
+    }
+    return 1;
+}
+
+/**
+ * Write exactly a given number of bytes to a connection.
+ * @param connection the connection's socket
+ * @param buffer the bytes to write
+ * @param bytes the number of bytes to write
+ * @return 1 if all the bytes were written, 0 if the connection was closed or failed first.
+ */
+static int writeAll(int connection, const void *buffer, size_t bytes) {
+    const char *position = buffer;
+    ssize_t count;
+    while (bytes > 0) {
+        count = write(connection, position, bytes);
+        if (count <= 0) {
+            return 0;
+        }
+        position += count;
+        bytes -= (size_t) count;
+    }
+    return 1;
+}
+
+/**
+ * Reply with a status only.
+ * @param connection the connection's socket
+ * @param status the status of the request
+ */
+static void replyStatus(int connection, ServerStatus status) {
+    int reply = status;
+    writeAll(connection, &reply, sizeof(int));
+}
+
+/**
+ * Reply with a division, in the output file format.
+ * @param connection the connection's socket
+ * @param groupLst list of vertices groups, with their vertices in increasing order
+ */
+static void replyDivision(int connection, LinkedList *groupLst) {
+    size_t length;
+    int *buffer;
+    sortGroupList(groupLst);
+    length = 1 + getOutputLength(groupLst);
+    buffer = malloc(length * sizeof(int));
+    assertMemoryAllocation(buffer);
+    buffer[0] = SERVER_OK;
+    fillOutputBuffer(groupLst, buffer + 1);
+    writeAll(connection, buffer, length * sizeof(int));
+    free(buffer);
+}
+
+/**
+ * Read the vertices of a subset request into a group.
+ * @param connection the connection's socket
+ * @param n the number of vertices of the graph
+ * @return the group of the vertices, in increasing order, or NULL if the request is not valid
+ */
+static VerticesGroup *readSubset(int connection, int n) {
+    VerticesGroup *group;
+    int count, i;
+    if (!readAll(connection, &count, sizeof(int)) || count < 1 || count > n) {
+        return NULL;
+    }
+    group = createVerticesGroup(count);
+    if (!readAll(connection, group->verticesArr, count * sizeof(int))) {
+        freeVerticesGroup(group);
+        return NULL;
+    }
+    group->size = count;
+    qsort(group->verticesArr, count, sizeof(int), compareInts);
+    for (i = 0; i < count; ++i) {
+        if (group->verticesArr[i] < 0 || group->verticesArr[i] >= n ||
+            (i > 0 && group->verticesArr[i] == group->verticesArr[i - 1])) {
+            freeVerticesGroup(group);
+            return NULL;
+        }
+    }
+    return group;
+}
+
+/**
+ * Divide a graph, or the subgraph induced by a subset of its vertices, and reply with the division.
+ * @param connection the connection's socket
+ * @param G graph object
+ * @param command SERVER_CLUSTER or SERVER_CLUSTER_SUBSET
+ */
+static void serveDivision(int connection, Graph *G, ServerCommand command) {
+    DivisionSettings settings;
+    VerticesGroup *group;
+    LinkedList *groupLst;
+    Graph *subgraph;
+    unsigned int seed[2];
+    if (!readAll(connection, seed, sizeof(seed))) {
+        return;
+    }
+    initDivisionSettings(&settings);
+    settings.seed = (unsigned long) seed[0] | (((unsigned long) seed[1] << 16) << 16);
+
+    if (command == SERVER_CLUSTER) {
+        groupLst = divisionAlgorithm(G, &settings);
+        sortGroupVertices(groupLst);
+    } else {
+        group = readSubset(connection, G->n);
+        if (group == NULL) {
+            replyStatus(connection, SERVER_BAD_REQUEST);
+            return;
+        }
+        subgraph = constructInducedGraph(G, group);
+        freeVerticesGroup(group);
+        groupLst = divisionAlgorithm(subgraph, &settings);
+        restoreOriginalIndices(groupLst, subgraph->originalIndices);
+        destroyGraph(subgraph);
+    }
+    replyDivision(connection, groupLst);
+    deepFreeGroupList(groupLst);
+}
+
+/**
+ * Serve a single request of a connection.
+ * @param connection the connection's socket
+ * @param graphs the resident graphs
+ * @param graphsCount the number of resident graphs
+ * @return 0 if the server should stop, 1 otherwise
+ */
+static int serveRequest(int connection, ResidentGraph *graphs, int graphsCount) {
+    char name[SERVER_MAX_NAME_LENGTH + 1];
+    int command, nameLength, i;
+    if (!readAll(connection, &command, sizeof(int)) || !readAll(connection, &nameLength, sizeof(int))) {
+        return 1;
+    }
+    if (nameLength < 0 || nameLength > SERVER_MAX_NAME_LENGTH) {
+        replyStatus(connection, SERVER_BAD_REQUEST);
+        return 1;
+    }
+    if (!readAll(connection, name, nameLength)) {
+        return 1;
+    }
+    name[nameLength] = '\0';
+
+    if (command == SERVER_SHUTDOWN) {
+        replyStatus(connection, SERVER_OK);
+        return 0;
+    }
+    if (command != SERVER_CLUSTER && command != SERVER_CLUSTER_SUBSET) {
+        replyStatus(connection, SERVER_BAD_REQUEST);
+        return 1;
+    }
+    for (i = 0; i < graphsCount; ++i) {
+        if (strcmp(graphs[i].name, name) == 0) {
+            serveDivision(connection, graphs[i].G, (ServerCommand) command);
+            return 1;
+        }
+    }
+    replyStatus(connection, SERVER_UNKNOWN_GRAPH);
+    return 1;
+}
+
+/**
+ * Serve the request of a connection, and close it.
+ * @param argument the connection (a ServerConnection), freed
+ * @return NULL
+ */
+static void *serveConnection(void *argument) {
+    ServerConnection *client = (ServerConnection *) argument;
+    Server *server = client->server;
+    char drain[256];
+    size_t drained = 0;
+    ssize_t count;
+    int running = serveRequest(client->connection, server->graphs, server->graphsCount);
+    /* the rest of a rejected request is read before closing, as unread data would reset the reply, but only up to
+     * a limit, and every read is bounded by the timeout of the connection */
+    shutdown(client->connection, SHUT_WR);
+    while (drained < SERVER_DRAIN_LIMIT && (count = read(client->connection, drain, sizeof(drain))) > 0) {
+        drained += (size_t) count;
+    }
+    close(client->connection);
+    free(client);
+
+    pthread_mutex_lock(&server->lock);
+    if (!running && server->running) {
+        server->running = 0;
+        /* wakes the accepting thread */
+        shutdown(server->listener, SHUT_RDWR);
+    }
+    server->connections--;
+    pthread_cond_broadcast(&server->done);
+    pthread_mutex_unlock(&server->lock);
+    return NULL;
+}
+
+/**
+ * Open the listening socket of the server, replacing a stale socket file of the same path.
+ * Any other file of that path is left as it is, and the server does not start.
+ * @param path path of the socket
+ * @return the listening socket
+ */
+int openServerSocket(char *path) {
+    struct sockaddr_un address;
+    struct stat status;
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    assertBooleanStatementIsTrue(listener >= 0);
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        throw("The socket path is too long");
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+    if (lstat(path, &status) == 0) {
+        if (!S_ISSOCK(status.st_mode)) {
+            throw("The socket path exists, and is not a socket");
+        }
+        unlink(path);
+    }
+    if (bind(listener, (struct sockaddr *) &address, sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0) {
+        throw("Could not listen on the socket");
+    }
+    return listener;
+}
+
+/**
+ * Serve the connections of a listening socket until a SERVER_SHUTDOWN request, every one by a thread of its own.
+ * Every read and write of a connection times out after SERVER_TIMEOUT_SECONDS, so an idle or slow client only holds
+ * its own thread. Returns once all the connections are closed.
+ * @param listener the listening socket, as opened by openServerSocket
+ * @param graphs the resident graphs, which the divisions only read
+ * @param graphsCount the number of resident graphs
+ */
+void runServer(int listener, ResidentGraph *graphs, int graphsCount) {
+    Server server;
+    ServerConnection *client;
+    struct timeval timeout;
+    pthread_t worker;
+    int connection, running = 1;
+    server.listener = listener;
+    server.graphs = graphs;
+    server.graphsCount = graphsCount;
+    server.running = 1;
+    server.connections = 0;
+    pthread_mutex_init(&server.lock, NULL);
+    pthread_cond_init(&server.done, NULL);
+    timeout.tv_sec = SERVER_TIMEOUT_SECONDS;
+    timeout.tv_usec = 0;
+    /* a client closing its connection early should not stop the server */
+    signal(SIGPIPE, SIG_IGN);
+
+    while (running) {
+        pthread_mutex_lock(&server.lock);
+        while (server.running && server.connections >= SERVER_MAX_CONNECTIONS) {
+            pthread_cond_wait(&server.done, &server.lock);
+        }
+        running = server.running;
+        pthread_mutex_unlock(&server.lock);
+        if (!running) {
+            break;
+        }
+        connection = accept(listener, NULL, NULL);
+        if (connection < 0) {
+            /* the listener is shut down by a SERVER_SHUTDOWN request */
+            continue;
+        }
+        setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        client = malloc(sizeof(ServerConnection));
+        assertMemoryAllocation(client);
+        client->server = &server;
+        client->connection = connection;
+        pthread_mutex_lock(&server.lock);
+        server.connections++;
+        pthread_mutex_unlock(&server.lock);
+        assertBooleanStatementIsTrue(pthread_create(&worker, NULL, serveConnection, client) == 0);
+        pthread_detach(worker);
+    }
+
+    pthread_mutex_lock(&server.lock);
+    while (server.connections > 0) {
+        pthread_cond_wait(&server.done, &server.lock);
+    }
+    pthread_mutex_unlock(&server.lock);
+    pthread_mutex_destroy(&server.lock);
+    pthread_cond_destroy(&server.done);
+}
+
+#ifndef CLUSTER_NO_MAIN
+
+/**
+ * Runs the clustering server: loads the graphs, and serves requests until a SERVER_SHUTDOWN request.
+ * The command line is the socket path, followed by the name and the input file of every graph.
+ * @param argc number of command line arguments
+ * @param argv command line arguments
+ * @return 0
+ */
+int main(int argc, char **argv) {
+    ResidentGraph *graphs;
+    int graphsCount = (argc - 2) / 2, listener, i;
+    if (argc < 4 || argc % 2 != 0) {
+        throw("Expected a socket path, and a name and an input file for every graph");
+    }
+    graphs = malloc(graphsCount * sizeof(ResidentGraph));
+    assertMemoryAllocation(graphs);
+    for (i = 0; i < graphsCount; ++i) {
+        graphs[i].name = argv[2 + 2 * i];
+        if (strlen(graphs[i].name) > SERVER_MAX_NAME_LENGTH) {
+            throw("The name of a graph is too long");
+        }
+        graphs[i].G = constructGraphFromInput(argv[3 + 2 * i]);
+    }
+
+    listener = openServerSocket(argv[1]);
+    runServer(listener, graphs, graphsCount);
+    close(listener);
+    unlink(argv[1]);
+
+    for (i = 0; i < graphsCount; ++i) {
+        destroyGraph(graphs[i].G);
+    }
+    free(graphs);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef CLUSTER_SERVER_H
+#define CLUSTER_SERVER_H
+
+#include "graph.h"
+
+/*
+ * A resident clustering server: the graphs are loaded once, when it starts, and every request over its Unix domain
+ * socket is answered from memory. A connection carries a single request and its reply, both sequences of integers
+ * (in the byte order of the host):
+ *   the command, the length of the graph's name and the name itself (as bytes), then
+ *   SERVER_CLUSTER: the low and high 32 bits of the seed, and the whole graph is divided.
+ *   SERVER_CLUSTER_SUBSET: the low and high 32 bits of the seed, the number of vertices and the vertices, and the
+ *   subgraph they induce (their edges between themselves) is divided.
+ *   SERVER_SHUTDOWN: nothing else (and the name is ignored), the server stops after replying.
+ * The reply is a ServerStatus, followed for a successful division by the division in the output file format, in the
+ * canonical order of --replay, with the vertices of the graph (not of the subgraph).
+ * The groups are divided with the default settings, so a reply equals the output of
+ * "cluster --replay --seed SEED" on the graph (or on the subgraph, relabeled back).
+ * Every connection is served by a thread of its own, as the divisions only read the graphs, and times out if its
+ * client is idle, so a slow client never holds up the others.
+ */
+
+/* the longest name of a graph */
+#define SERVER_MAX_NAME_LENGTH 255
+/* seconds a read or a write of a connection waits for its client */
+#define SERVER_TIMEOUT_SECONDS 10
+/* the most bytes read from a connection after the reply, to close it without resetting the reply */
+#define SERVER_DRAIN_LIMIT 65536
+
+typedef enum _serverCommand {
+    SERVER_CLUSTER = 1,
+    SERVER_CLUSTER_SUBSET = 2,
+    SERVER_SHUTDOWN = 3
+} ServerCommand;
+
+typedef enum _serverStatus {
+    SERVER_OK = 0,
+    /* no graph was loaded by the name of the request */
+    SERVER_UNKNOWN_GRAPH = 1,
+    /* an unknown command, or vertices which are out of range or repeated */
+    SERVER_BAD_REQUEST = 2
+} ServerStatus;
+
+typedef struct _residentGraph {
+    char *name;
+    Graph *G;
+} ResidentGraph;
+
+int openServerSocket(char *path);
+
+void runServer(int listener, ResidentGraph *graphs, int graphsCount);
+
+#endif
@@ -1,5 +1,9 @@
+#define _POSIX_C_SOURCE 200112L
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
+#include <pthread.h>
 #include "spmat.h"
 #include "ErrorHandler.h"
 
@@ -69,6 +73,7 @@ void list_free(struct _spmat *A);
 
 void list_mult(const struct _spmat *A, const double *v, double *result);
 
+double list_get(const struct _spmat *A, int i, int j);
 
 /**
  * Initialize a new list-based sparse matrix.
@@ -86,6 +91,7 @@ spmat *spmat_allocate_list(int n) {
     mat->add_row = list_add_row;
     mat->free = list_free;
     mat->mult = list_mult;
+    mat->get = list_get;
     /* private field holds an array of row lists */
     mat->private = row_lists;
     return mat;
@@ -142,3 +148,1040 @@ void list_mult(const struct _spmat *A, const double *v, double *result) {
         result[i] = sum;
     }
 }
+
+/**
+ * Finds a value of a lists-based sparse matrix.
+ * The lists are ordered by column, so the search stops at the first larger column.
+ * @param A a lists-based sparse matrix.
+ * @param i the row index.
+ * @param j the column index.
+ * @return the value A[i][j].
+ */
+double list_get(const struct _spmat *A, int i, int j) {
+    register nodeRef currElem;
+    for (currElem = ((nodeRef *) A->private)[i]; currElem != NULL && currElem->colind <= j; currElem = currElem->next) {
+        if (currElem->colind == j)
+            return currElem->value;
+    }
+    return 0;
+}
+
+/* array operations */
+void array_add_row(struct _spmat *A, const double *row, int i);
+
+void array_free(struct _spmat *A);
+
+void array_mult(const struct _spmat *A, const double *v, double *result);
+
+double array_get(const struct _spmat *A, int i, int j);
+
+/**
+ * Makes room for at least nnz values in the arrays of a sparse matrix, doubling their capacity as needed.
+ * @param arrays the arrays of the matrix.
+ * @param nnz the number of values to hold.
+ */
+static void arrays_reserve(csr *arrays, int nnz) {
+    if (nnz <= arrays->capacity)
+        return;
+    arrays->capacity = nnz > 2 * arrays->capacity ? nnz : 2 * arrays->capacity;
+    arrays->values = realloc(arrays->values, arrays->capacity * sizeof(double));
+    arrays->colind = realloc(arrays->colind, arrays->capacity * sizeof(int));
+    assertMemoryAllocation(arrays->values);
+    assertMemoryAllocation(arrays->colind);
+}
+
+/**
+ * Allocates the arrays of an arrays-based or symmetric sparse matrix.
+ * @param n the dimension of the matrix.
+ * @param nnz the initial capacity of the values.
+ * @return the empty arrays.
+ */
+static csr *arrays_allocate(int n, int nnz) {
+    register csr *arrays = malloc(sizeof(csr));
+    assertMemoryAllocation(arrays);
+    /* one extra cell, so an empty matrix is a valid allocation */
+    arrays->capacity = nnz + 1;
+    arrays->values = malloc(arrays->capacity * sizeof(double));
+    arrays->colind = malloc(arrays->capacity * sizeof(int));
+    arrays->rowptr = malloc((n + 1) * sizeof(int));
+    assertMemoryAllocation(arrays->values);
+    assertMemoryAllocation(arrays->colind);
+    assertMemoryAllocation(arrays->rowptr);
+    arrays->rowptr[0] = 0;
+    return arrays;
+}
+
+/**
+ * Initialize a new array-based (compressed sparse row) sparse matrix.
+ * The private field holds the values, column indices and row pointers arrays.
+ * Rows should be added in increasing order, or the arrays may be filled directly.
+ * @param n the dimension of the matrix.
+ * @param nnz the number of non-zero values of the matrix.
+ * @return a pointer to a sparse matrix structure, implemented by arrays.
+ */
+spmat *spmat_allocate_array(int n, int nnz) {
+    register spmat *mat = malloc(sizeof(spmat));
+    assertMemoryAllocation(mat);
+    mat->n = n;
+    mat->add_row = array_add_row;
+    mat->free = array_free;
+    mat->mult = array_mult;
+    mat->get = array_get;
+    mat->private = arrays_allocate(n, nnz);
+    return mat;
+}
+
+/**
+ * Given an arrays-implemented sparse matrix,
+ * this function inserts a given row as the i'th row. Rows 0 .. i-1 should be inserted already.
+ * @param A a pointer to the sparse matrix.
+ * @param row a pointer to the row base address.
+ * @param i the inserted row's index.
+ */
+void array_add_row(struct _spmat *A, const double *row, int i) {
+    register csr *arrays = (csr *) A->private;
+    register int j, nnz = arrays->rowptr[i];
+    for (j = 0; j < A->n; ++j) {
+        if (row[j] != 0) {
+            arrays_reserve(arrays, nnz + 1);
+            arrays->values[nnz] = row[j];
+            arrays->colind[nnz] = j;
+            ++nnz;
+        }
+    }
+    arrays->rowptr[i + 1] = nnz;
+}
+
+/**
+ * Frees up every resource that has been dynamically allocated
+ * by an arrays-based sparse matrix.
+ * @param A a pointer to the array-based sparse matrix.
+ */
+void array_free(struct _spmat *A) {
+    register csr *arrays;
+    assertMemoryAllocation(A);
+    arrays = (csr *) A->private;
+    free(arrays->values);
+    free(arrays->colind);
+    free(arrays->rowptr);
+    free(arrays);
+    free(A);
+}
+
+/**
+ * Multiplies an arrays-based sparse matrix by a given vector.
+ * Saves the result to a new vector.
+ * @param A an arrays-based sparse matrix, of capacity n by n, to be multiplied.
+ * @param v a column vector of capacity n to be multiplied.
+ * @param result a new empty or arbitrary vector of capacity n, to be filled with the multiplication result.
+ */
+void array_mult(const struct _spmat *A, const double *v, double *result) {
+    register int i, k;
+    register double sum;
+    register csr *arrays = (csr *) A->private;
+    for (i = 0; i < A->n; ++i) {
+        sum = 0;
+        for (k = arrays->rowptr[i]; k < arrays->rowptr[i + 1]; ++k) {
+            sum += v[arrays->colind[k]] * arrays->values[k];
+        }
+        result[i] = sum;
+    }
+}
+
+/**
+ * Finds a value in row i of the arrays, by bisection over its ordered columns.
+ * @param arrays the arrays of the matrix.
+ * @param i the row index.
+ * @param j the column index.
+ * @return the value A[i][j].
+ */
+static double arrays_find(const csr *arrays, int i, int j) {
+    register int low = arrays->rowptr[i], high = arrays->rowptr[i + 1] - 1, middle;
+    while (low <= high) {
+        middle = (low + high) / 2;
+        if (arrays->colind[middle] == j)
+            return arrays->values[middle];
+        if (arrays->colind[middle] < j)
+            low = middle + 1;
+        else
+            high = middle - 1;
+    }
+    return 0;
+}
+
+/**
+ * Finds a value of an arrays-based sparse matrix.
+ * @param A an arrays-based sparse matrix.
+ * @param i the row index.
+ * @param j the column index.
+ * @return the value A[i][j].
+ */
+double array_get(const struct _spmat *A, int i, int j) {
+    return arrays_find((const csr *) A->private, i, j);
+}
+
+/* symmetric operations */
+void symmetric_add_row(struct _spmat *A, const double *row, int i);
+
+void symmetric_mult(const struct _spmat *A, const double *v, double *result);
+
+double symmetric_get(const struct _spmat *A, int i, int j);
+
+/**
+ * Initialize a new symmetric sparse matrix, which keeps the upper triangle in the arrays format.
+ * The arrays grow as rows are added, so nnz is only a hint.
+ * @param n the dimension of the matrix.
+ * @param nnz the expected number of values in the upper triangle (diagonal included).
+ * @return a pointer to a sparse matrix structure, implemented by arrays of the upper triangle.
+ */
+spmat *spmat_allocate_symmetric(int n, int nnz) {
+    register spmat *mat = malloc(sizeof(spmat));
+    assertMemoryAllocation(mat);
+    mat->n = n;
+    mat->add_row = symmetric_add_row;
+    mat->free = array_free;
+    mat->mult = symmetric_mult;
+    mat->get = symmetric_get;
+    mat->private = arrays_allocate(n, nnz);
+    return mat;
+}
+
+/**
+ * Given a symmetric sparse matrix, this function inserts a given row as the i'th row.
+ * Only the values on or right of the diagonal are kept, the rest are known from the previous rows.
+ * Rows 0 .. i-1 should be inserted already.
+ * @param A a pointer to the sparse matrix.
+ * @param row a pointer to the row base address.
+ * @param i the inserted row's index.
+ */
+void symmetric_add_row(struct _spmat *A, const double *row, int i) {
+    register csr *arrays = (csr *) A->private;
+    register int j, nnz = arrays->rowptr[i];
+    for (j = i; j < A->n; ++j) {
+        if (row[j] != 0) {
+            arrays_reserve(arrays, nnz + 1);
+            arrays->values[nnz] = row[j];
+            arrays->colind[nnz] = j;
+            ++nnz;
+        }
+    }
+    arrays->rowptr[i + 1] = nnz;
+}
+
+/**
+ * Multiplies a symmetric sparse matrix by a given vector.
+ * Every stored value A[i][j] contributes to result[i], and (off the diagonal) to result[j] as A[j][i].
+ * @param A a symmetric sparse matrix, of capacity n by n, to be multiplied.
+ * @param v a column vector of capacity n to be multiplied.
+ * @param result a new empty or arbitrary vector of capacity n, to be filled with the multiplication result.
+ */
+void symmetric_mult(const struct _spmat *A, const double *v, double *result) {
+    register int i, j, k;
+    register double sum, vi;
+    register csr *arrays = (csr *) A->private;
+    for (i = 0; i < A->n; ++i) {
+        result[i] = 0;
+    }
+    for (i = 0; i < A->n; ++i) {
+        sum = 0;
+        vi = v[i];
+        for (k = arrays->rowptr[i]; k < arrays->rowptr[i + 1]; ++k) {
+            j = arrays->colind[k];
+            sum += v[j] * arrays->values[k];
+            if (j != i) {
+                /* the transposed half */
+                result[j] += vi * arrays->values[k];
+            }
+        }
+        result[i] += sum;
+    }
+}
+
+/**
+ * Finds a value of a symmetric sparse matrix, in the row of the smaller index.
+ * @param A a symmetric sparse matrix.
+ * @param i the row index.
+ * @param j the column index.
+ * @return the value A[i][j].
+ */
+double symmetric_get(const struct _spmat *A, int i, int j) {
+    return i <= j ? arrays_find((const csr *) A->private, i, j) : arrays_find((const csr *) A->private, j, i);
+}
+
+/* compressed operations */
+typedef struct _compressed {
+    /* the varint-encoded column gaps of all the rows */
+    unsigned char *bytes;
+    /* row i occupies the bytes rowptr[i] .. rowptr[i + 1] - 1 */
+    int *rowptr;
+    /* number of bytes the array can hold */
+    int capacity;
+} compressed;
+
+void compressed_add_row(struct _spmat *A, const double *row, int i);
+
+void compressed_free(struct _spmat *A);
+
+void compressed_mult(const struct _spmat *A, const double *v, double *result);
+
+double compressed_get(const struct _spmat *A, int i, int j);
+
+/**
+ * Initialize a new compressed sparse matrix, which keeps the pattern of a 0/1 matrix as varint-encoded gaps.
+ * The bytes array grows as rows are added, so its initial size is only a hint.
+ * @param n the dimension of the matrix.
+ * @param bytes the expected number of bytes of the encoding.
+ * @return a pointer to a sparse matrix structure, implemented by compressed rows.
+ */
+spmat *spmat_allocate_compressed(int n, int bytes) {
+    register spmat *mat = malloc(sizeof(spmat));
+    register compressed *rows = malloc(sizeof(compressed));
+    assertMemoryAllocation(mat);
+    assertMemoryAllocation(rows);
+    rows->capacity = bytes + 1;
+    rows->bytes = malloc(rows->capacity);
+    rows->rowptr = malloc((n + 1) * sizeof(int));
+    assertMemoryAllocation(rows->bytes);
+    assertMemoryAllocation(rows->rowptr);
+    rows->rowptr[0] = 0;
+    mat->n = n;
+    mat->add_row = compressed_add_row;
+    mat->free = compressed_free;
+    mat->mult = compressed_mult;
+    mat->get = compressed_get;
+    mat->private = rows;
+    return mat;
+}
+
+/**
+ * Given a compressed sparse matrix, this function inserts a given row as the i'th row.
+ * Every non-zero value of the row should be 1. Rows 0 .. i-1 should be inserted already.
+ * @param A a pointer to the sparse matrix.
+ * @param row a pointer to the row base address.
+ * @param i the inserted row's index.
+ */
+void compressed_add_row(struct _spmat *A, const double *row, int i) {
+    register compressed *rows = (compressed *) A->private;
+    register int j, previous = -1, length = rows->rowptr[i];
+    register unsigned int gap;
+    for (j = 0; j < A->n; ++j) {
+        if (row[j] != 0) {
+            assertBooleanStatementIsTrue(row[j] == 1);
+            /* a gap takes at most 5 bytes */
+            if (length + 5 > rows->capacity) {
+                rows->capacity = 2 * rows->capacity + 5;
+                rows->bytes = realloc(rows->bytes, rows->capacity);
+                assertMemoryAllocation(rows->bytes);
+            }
+            gap = (unsigned int) (j - previous - 1);
+            while (gap >= 0x80) {
+                rows->bytes[length++] = (unsigned char) (gap | 0x80);
+                gap >>= 7;
+            }
+            rows->bytes[length++] = (unsigned char) gap;
+            previous = j;
+        }
+    }
+    rows->rowptr[i + 1] = length;
+}
+
+/**
+ * Frees up every resource that has been dynamically allocated
+ * by a compressed sparse matrix.
+ * @param A a pointer to the compressed sparse matrix.
+ */
+void compressed_free(struct _spmat *A) {
+    register compressed *rows;
+    assertMemoryAllocation(A);
+    rows = (compressed *) A->private;
+    free(rows->bytes);
+    free(rows->rowptr);
+    free(rows);
+    free(A);
+}
+
+/**
+ * Multiplies a compressed sparse matrix by a given vector, decoding the columns while multiplying.
+ * The columns of a row are summed in increasing order, as in the other formats.
+ * @param A a compressed sparse matrix, of capacity n by n, to be multiplied.
+ * @param v a column vector of capacity n to be multiplied.
+ * @param result a new empty or arbitrary vector of capacity n, to be filled with the multiplication result.
+ */
+void compressed_mult(const struct _spmat *A, const double *v, double *result) {
+    register int i, j, shift;
+    register unsigned int gap;
+    register double sum;
+    register const unsigned char *current, *end;
+    register compressed *rows = (compressed *) A->private;
+    for (i = 0; i < A->n; ++i) {
+        sum = 0;
+        j = -1;
+        current = rows->bytes + rows->rowptr[i];
+        end = rows->bytes + rows->rowptr[i + 1];
+        while (current < end) {
+            gap = *current & 0x7F;
+            for (shift = 7; *current++ & 0x80; shift += 7) {
+                gap |= (unsigned int) (*current & 0x7F) << shift;
+            }
+            j += (int) gap + 1;
+            sum += v[j];
+        }
+        result[i] = sum;
+    }
+}
+
+/**
+ * Finds a value of a compressed sparse matrix, by decoding row i up to column j.
+ * @param A a compressed sparse matrix.
+ * @param i the row index.
+ * @param j the column index.
+ * @return the value A[i][j] (0 or 1).
+ */
+double compressed_get(const struct _spmat *A, int i, int j) {
+    register int column = -1, shift;
+    register unsigned int gap;
+    register compressed *rows = (compressed *) A->private;
+    register const unsigned char *current = rows->bytes + rows->rowptr[i];
+    register const unsigned char *end = rows->bytes + rows->rowptr[i + 1];
+    while (current < end && column < j) {
+        gap = *current & 0x7F;
+        for (shift = 7; *current++ & 0x80; shift += 7) {
+            gap |= (unsigned int) (*current & 0x7F) << shift;
+        }
+        column += (int) gap + 1;
+    }
+    return column == j;
+}
+
+/* sliced ELLPACK operations */
+typedef struct _sell {
+    int chunkHeight;
+    int sigma;
+    int chunksCount;
+    /* the values of chunk c start at chunkptr[c], where the k'th value of its r'th row is at k * chunkHeight + r */
+    int *chunkptr;
+    int *chunkWidth;
+    double *values;
+    int *colind;
+    /* the original index of the row at every position (-1 for the padding rows of the last chunk),
+     * the position of every original row, and the length of the row at every position */
+    int *rows;
+    int *positions;
+    int *lengths;
+    /* the rows are collected in the arrays format until the last one is added */
+    spmat *staging;
+} sell;
+
+void sell_add_row(struct _spmat *A, const double *row, int i);
+
+void sell_free(struct _spmat *A);
+
+void sell_mult(const struct _spmat *A, const double *v, double *result);
+
+double sell_get(const struct _spmat *A, int i, int j);
+
+/**
+ * Get the chunk height matching the SIMD width of the running processor, in doubles:
+ * 8 for AVX-512, 4 for AVX2, and 2 otherwise (SSE2, or an unknown processor).
+ * @return the chunk height.
+ */
+int spmat_sell_chunk_height() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return 8;
+    if (__builtin_cpu_supports("avx2"))
+        return 4;
+#endif
+    return 2;
+}
+
+/**
+ * Initialize a new sliced ELLPACK (SELL-C-sigma) sparse matrix.
+ * @param n the dimension of the matrix.
+ * @param chunkHeight the number of rows of a chunk (C), between 1 and SELL_MAX_CHUNK_HEIGHT.
+ * @param sigma the number of rows of a sorting window, 1 keeps the rows in their order.
+ * @return a pointer to a sparse matrix structure, implemented by sliced ELLPACK.
+ */
+spmat *spmat_allocate_sell(int n, int chunkHeight, int sigma) {
+    register spmat *mat = malloc(sizeof(spmat));
+    register sell *chunks = malloc(sizeof(sell));
+    assertMemoryAllocation(mat);
+    assertMemoryAllocation(chunks);
+    assertBooleanStatementIsTrue(chunkHeight >= 1 && chunkHeight <= SELL_MAX_CHUNK_HEIGHT && sigma >= 1);
+    chunks->chunkHeight = chunkHeight;
+    chunks->sigma = sigma;
+    chunks->chunksCount = (n + chunkHeight - 1) / chunkHeight;
+    chunks->chunkptr = NULL;
+    chunks->chunkWidth = NULL;
+    chunks->values = NULL;
+    chunks->colind = NULL;
+    chunks->rows = NULL;
+    chunks->positions = NULL;
+    chunks->lengths = NULL;
+    chunks->staging = spmat_allocate_array(n, n);
+    mat->n = n;
+    mat->add_row = sell_add_row;
+    mat->free = sell_free;
+    mat->mult = sell_mult;
+    mat->get = sell_get;
+    mat->private = chunks;
+    return mat;
+}
+
+/* a row and its length, for sorting the rows of a window */
+typedef struct _rowLength {
+    int row;
+    int length;
+} rowLength;
+
+static int compare_row_lengths(const void *a, const void *b) {
+    const rowLength *x = (const rowLength *) a, *y = (const rowLength *) b;
+    /* longer rows first, and the original order between rows of equal length */
+    if (x->length != y->length)
+        return y->length - x->length;
+    return x->row - y->row;
+}
+
+/**
+ * Builds the chunks of a sliced ELLPACK matrix from its staged rows, and frees them.
+ * @param A a pointer to the sparse matrix, whose rows were all added.
+ */
+static void sell_build(struct _spmat *A) {
+    register sell *chunks = (sell *) A->private;
+    register csr *arrays = (csr *) chunks->staging->private;
+    register int i, c, k, r, position, row, width, nnz = 0, C = chunks->chunkHeight;
+    rowLength *order = malloc((A->n + 1) * sizeof(rowLength));
+    assertMemoryAllocation(order);
+
+    /* sort the rows of every window by their length */
+    for (i = 0; i < A->n; ++i) {
+        order[i].row = i;
+        order[i].length = arrays->rowptr[i + 1] - arrays->rowptr[i];
+    }
+    for (i = 0; i < A->n; i += chunks->sigma) {
+        qsort(order + i, (A->n - i < chunks->sigma ? A->n - i : chunks->sigma), sizeof(rowLength),
+              compare_row_lengths);
+    }
+
+    chunks->chunkptr = malloc((chunks->chunksCount + 1) * sizeof(int));
+    chunks->chunkWidth = malloc((chunks->chunksCount + 1) * sizeof(int));
+    chunks->rows = malloc((chunks->chunksCount * C + 1) * sizeof(int));
+    chunks->positions = malloc((A->n + 1) * sizeof(int));
+    chunks->lengths = malloc((chunks->chunksCount * C + 1) * sizeof(int));
+    assertMemoryAllocation(chunks->chunkptr);
+    assertMemoryAllocation(chunks->chunkWidth);
+    assertMemoryAllocation(chunks->rows);
+    assertMemoryAllocation(chunks->positions);
+    assertMemoryAllocation(chunks->lengths);
+    for (c = 0; c < chunks->chunksCount; ++c) {
+        width = 0;
+        for (r = 0; r < C; ++r) {
+            position = c * C + r;
+            chunks->rows[position] = position < A->n ? order[position].row : -1;
+            chunks->lengths[position] = position < A->n ? order[position].length : 0;
+            if (position < A->n)
+                chunks->positions[order[position].row] = position;
+            if (chunks->lengths[position] > width)
+                width = chunks->lengths[position];
+        }
+        chunks->chunkptr[c] = nnz;
+        chunks->chunkWidth[c] = width;
+        nnz += width * C;
+    }
+    chunks->chunkptr[chunks->chunksCount] = nnz;
+
+    /* copy the rows, column-major inside every chunk, padding with zeros */
+    chunks->values = malloc((nnz + 1) * sizeof(double));
+    chunks->colind = malloc((nnz + 1) * sizeof(int));
+    assertMemoryAllocation(chunks->values);
+    assertMemoryAllocation(chunks->colind);
+    for (c = 0; c < chunks->chunksCount; ++c) {
+        for (r = 0; r < C; ++r) {
+            row = chunks->rows[c * C + r];
+            for (k = 0; k < chunks->chunkWidth[c]; ++k) {
+                position = chunks->chunkptr[c] + k * C + r;
+                if (row >= 0 && k < chunks->lengths[c * C + r]) {
+                    chunks->values[position] = arrays->values[arrays->rowptr[row] + k];
+                    chunks->colind[position] = arrays->colind[arrays->rowptr[row] + k];
+                } else {
+                    chunks->values[position] = 0;
+                    chunks->colind[position] = 0;
+                }
+            }
+        }
+    }
+
+    chunks->staging->free(chunks->staging);
+    chunks->staging = NULL;
+    free(order);
+}
+
+/**
+ * Given a sliced ELLPACK sparse matrix, this function inserts a given row as the i'th row.
+ * Rows 0 .. i-1 should be inserted already. The chunks are built when the last row is inserted.
+ * @param A a pointer to the sparse matrix.
+ * @param row a pointer to the row base address.
+ * @param i the inserted row's index.
+ */
+void sell_add_row(struct _spmat *A, const double *row, int i) {
+    register sell *chunks = (sell *) A->private;
+    chunks->staging->add_row(chunks->staging, row, i);
+    if (i == A->n - 1)
+        sell_build(A);
+}
+
+/**
+ * Frees up every resource that has been dynamically allocated
+ * by a sliced ELLPACK sparse matrix.
+ * @param A a pointer to the sliced ELLPACK sparse matrix.
+ */
+void sell_free(struct _spmat *A) {
+    register sell *chunks;
+    assertMemoryAllocation(A);
+    chunks = (sell *) A->private;
+    if (chunks->staging != NULL)
+        chunks->staging->free(chunks->staging);
+    free(chunks->chunkptr);
+    free(chunks->chunkWidth);
+    free(chunks->values);
+    free(chunks->colind);
+    free(chunks->rows);
+    free(chunks->positions);
+    free(chunks->lengths);
+    free(chunks);
+    free(A);
+}
+
+/**
+ * Multiplies a sliced ELLPACK sparse matrix by a given vector.
+ * The rows of a chunk advance together, one value each per step, and every row sums its values
+ * in increasing column order, as in the other formats.
+ * @param A a sliced ELLPACK sparse matrix, of capacity n by n, to be multiplied.
+ * @param v a column vector of capacity n to be multiplied.
+ * @param result a new empty or arbitrary vector of capacity n, to be filled with the multiplication result.
+ */
+void sell_mult(const struct _spmat *A, const double *v, double *result) {
+    register int c, k, r, C;
+    register const double *values;
+    register const int *colind;
+    double sums[SELL_MAX_CHUNK_HEIGHT];
+    register sell *chunks = (sell *) A->private;
+    C = chunks->chunkHeight;
+    for (c = 0; c < chunks->chunksCount; ++c) {
+        values = chunks->values + chunks->chunkptr[c];
+        colind = chunks->colind + chunks->chunkptr[c];
+        for (r = 0; r < C; ++r)
+            sums[r] = 0;
+        for (k = 0; k < chunks->chunkWidth[c]; ++k) {
+            for (r = 0; r < C; ++r)
+                sums[r] += v[colind[k * C + r]] * values[k * C + r];
+        }
+        for (r = 0; r < C; ++r) {
+            if (chunks->rows[c * C + r] >= 0)
+                result[chunks->rows[c * C + r]] = sums[r];
+        }
+    }
+}
+
+/**
+ * Finds a value of a sliced ELLPACK sparse matrix.
+ * @param A a sliced ELLPACK sparse matrix.
+ * @param i the row index.
+ * @param j the column index.
+ * @return the value A[i][j].
+ */
+double sell_get(const struct _spmat *A, int i, int j) {
+    register sell *chunks = (sell *) A->private;
+    register int k, C = chunks->chunkHeight, position = chunks->positions[i];
+    register int base = chunks->chunkptr[position / C] + position % C;
+    for (k = 0; k < chunks->lengths[position]; ++k) {
+        if (chunks->colind[base + k * C] == j)
+            return chunks->values[base + k * C];
+    }
+    return 0;
+}
+
+/* merge-path operations */
+typedef struct _mergePath {
+    int threads;
+    csr *arrays;
+} mergePath;
+
+/* the share of a single thread in a merge-path multiplication */
+typedef struct _mergePathShare {
+    const csr *arrays;
+    const double *v;
+    double *result;
+    int n;
+    /* the number of steps of the merge path, n + nnz */
+    int steps;
+    /* the chunks of the share, firstChunk .. endChunk - 1 */
+    int firstChunk;
+    int endChunk;
+    /* by chunk, the row whose beginning it leaves unfinished (n if none), and its partial sum */
+    int *carryRows;
+    double *carries;
+} mergePathShare;
+
+void merge_path_add_row(struct _spmat *A, const double *row, int i);
+
+void merge_path_free(struct _spmat *A);
+
+void merge_path_mult(const struct _spmat *A, const double *v, double *result);
+
+double merge_path_get(const struct _spmat *A, int i, int j);
+
+/**
+ * Initialize a new merge-path sparse matrix, which keeps the arrays format and multiplies it in parallel.
+ * @param n the dimension of the matrix.
+ * @param threads the largest number of threads of a multiplication.
+ * @return a pointer to a sparse matrix structure, implemented by arrays.
+ */
+spmat *spmat_allocate_merge_path(int n, int threads) {
+    register spmat *mat = malloc(sizeof(spmat));
+    register mergePath *path = malloc(sizeof(mergePath));
+    assertMemoryAllocation(mat);
+    assertMemoryAllocation(path);
+    assertBooleanStatementIsTrue(threads >= 1);
+    path->threads = threads;
+    path->arrays = arrays_allocate(n, n);
+    mat->n = n;
+    mat->add_row = merge_path_add_row;
+    mat->free = merge_path_free;
+    mat->mult = merge_path_mult;
+    mat->get = merge_path_get;
+    mat->private = path;
+    return mat;
+}
+
+/**
+ * Given a merge-path sparse matrix, this function inserts a given row as the i'th row.
+ * Rows 0 .. i-1 should be inserted already.
+ * @param A a pointer to the sparse matrix.
+ * @param row a pointer to the row base address.
+ * @param i the inserted row's index.
+ */
+void merge_path_add_row(struct _spmat *A, const double *row, int i) {
+    register csr *arrays = ((mergePath *) A->private)->arrays;
+    register int j, nnz = arrays->rowptr[i];
+    for (j = 0; j < A->n; ++j) {
+        if (row[j] != 0) {
+            arrays_reserve(arrays, nnz + 1);
+            arrays->values[nnz] = row[j];
+            arrays->colind[nnz] = j;
+            ++nnz;
+        }
+    }
+    arrays->rowptr[i + 1] = nnz;
+}
+
+/**
+ * Frees up every resource that has been dynamically allocated
+ * by a merge-path sparse matrix.
+ * @param A a pointer to the merge-path sparse matrix.
+ */
+void merge_path_free(struct _spmat *A) {
+    register mergePath *path;
+    assertMemoryAllocation(A);
+    path = (mergePath *) A->private;
+    free(path->arrays->values);
+    free(path->arrays->colind);
+    free(path->arrays->rowptr);
+    free(path->arrays);
+    free(path);
+    free(A);
+}
+
+/**
+ * Finds where a diagonal crosses the merge path of the row ends (rowptr[1..n]) and the non-zero indices (0..nnz-1).
+ * @param arrays the arrays of the matrix.
+ * @param n the dimension of the matrix.
+ * @param diagonal the diagonal, between 0 and n + nnz.
+ * @return the row of the crossing, whose first non-zero index is diagonal minus the row.
+ */
+static int merge_path_search(const csr *arrays, int n, int diagonal) {
+    register int low = diagonal - arrays->rowptr[n] > 0 ? diagonal - arrays->rowptr[n] : 0;
+    register int high = diagonal < n ? diagonal : n, middle;
+    while (low < high) {
+        middle = (low + high) / 2;
+        if (arrays->rowptr[middle + 1] <= diagonal - middle - 1)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+/**
+ * Multiplies the chunks of a single thread: the rows every chunk finishes are written to the result,
+ * and the sum of the row it leaves unfinished is kept as its carry.
+ * @param argument the share of the thread (a mergePathShare).
+ * @return NULL
+ */
+static void *merge_path_multiply_share(void *argument) {
+    register mergePathShare *share = (mergePathShare *) argument;
+    register const csr *arrays = share->arrays;
+    register int n = share->n, row, endRow, k, endK, c, endDiagonal;
+    register double sum;
+    for (c = share->firstChunk; c < share->endChunk; ++c) {
+        endDiagonal = (c + 1) * MERGE_PATH_CHUNK < share->steps ? (c + 1) * MERGE_PATH_CHUNK : share->steps;
+        row = merge_path_search(arrays, n, c * MERGE_PATH_CHUNK);
+        k = c * MERGE_PATH_CHUNK - row;
+        endRow = merge_path_search(arrays, n, endDiagonal);
+        endK = endDiagonal - endRow;
+        sum = 0;
+        for (; row < endRow; ++row) {
+            for (; k < arrays->rowptr[row + 1]; ++k)
+                sum += share->v[arrays->colind[k]] * arrays->values[k];
+            share->result[row] = sum;
+            sum = 0;
+        }
+        for (; k < endK; ++k)
+            sum += share->v[arrays->colind[k]] * arrays->values[k];
+        share->carryRows[c] = endRow;
+        share->carries[c] = sum;
+    }
+    return NULL;
+}
+
+/**
+ * Multiplies a merge-path sparse matrix by a given vector.
+ * The n + nnz steps of the multiplication (a step per non-zero, and a step per finished row) are cut into chunks of
+ * MERGE_PATH_CHUNK steps, which are split evenly between the threads, so a row of many non-zero values is shared by
+ * several chunks. The partial sums of the shared rows are added in the order of the chunks after all the threads
+ * finish, so the result does not depend on the number of threads.
+ * @param A a merge-path sparse matrix, of capacity n by n, to be multiplied.
+ * @param v a column vector of capacity n to be multiplied.
+ * @param result a new empty or arbitrary vector of capacity n, to be filled with the multiplication result.
+ */
+void merge_path_mult(const struct _spmat *A, const double *v, double *result) {
+    register mergePath *path = (mergePath *) A->private;
+    register int t, c, threads, chunks, steps = A->n + path->arrays->rowptr[A->n];
+    mergePathShare *shares;
+    pthread_t *workers;
+    int *carryRows;
+    double *carries;
+
+    chunks = steps > 0 ? (steps - 1) / MERGE_PATH_CHUNK + 1 : 1;
+    threads = chunks < path->threads ? chunks : path->threads;
+    shares = malloc(threads * sizeof(mergePathShare));
+    workers = malloc(threads * sizeof(pthread_t));
+    carryRows = malloc(chunks * sizeof(int));
+    carries = malloc(chunks * sizeof(double));
+    assertMemoryAllocation(shares);
+    assertMemoryAllocation(workers);
+    assertMemoryAllocation(carryRows);
+    assertMemoryAllocation(carries);
+    for (t = 0; t < threads; ++t) {
+        shares[t].arrays = path->arrays;
+        shares[t].v = v;
+        shares[t].result = result;
+        shares[t].n = A->n;
+        shares[t].steps = steps;
+        shares[t].firstChunk = (int) ((double) chunks * t / threads);
+        shares[t].endChunk = (int) ((double) chunks * (t + 1) / threads);
+        shares[t].carryRows = carryRows;
+        shares[t].carries = carries;
+    }
+
+    /* the calling thread takes the first share */
+    for (t = 1; t < threads; ++t)
+        assertBooleanStatementIsTrue(pthread_create(&workers[t], NULL, merge_path_multiply_share, &shares[t]) == 0);
+    merge_path_multiply_share(&shares[0]);
+    for (t = 1; t < threads; ++t)
+        pthread_join(workers[t], NULL);
+
+    /* every carry belongs to a row which a later chunk finished (or the end, for the last one) */
+    for (c = 0; c < chunks; ++c) {
+        if (carryRows[c] < A->n)
+            result[carryRows[c]] += carries[c];
+    }
+    free(carries);
+    free(carryRows);
+    free(shares);
+    free(workers);
+}
+
+/**
+ * Finds a value of a merge-path sparse matrix.
+ * @param A a merge-path sparse matrix.
+ * @param i the row index.
+ * @param j the column index.
+ * @return the value A[i][j].
+ */
+double merge_path_get(const struct _spmat *A, int i, int j) {
+    return arrays_find(((mergePath *) A->private)->arrays, i, j);
+}
+
+/* bitset operations */
+#define WORD_BITS ((int) (CHAR_BIT * sizeof(unsigned long)))
+
+typedef struct _bitset {
+    /* the number of words of a row */
+    int words;
+    /* the bits of row i are bit j % WORD_BITS of bits[i * words + j / WORD_BITS] */
+    unsigned long *bits;
+    /* the number of values set in every row */
+    int *degrees;
+} bitset;
+
+void bitset_add_row(struct _spmat *A, const double *row, int i);
+
+void bitset_free(struct _spmat *A);
+
+void bitset_mult(const struct _spmat *A, const double *v, double *result);
+
+double bitset_get(const struct _spmat *A, int i, int j);
+
+/**
+ * Counts the set bits of a word.
+ * @param word the word.
+ * @return the number of bits set.
+ */
+static int count_bits(unsigned long word) {
+#if defined(__GNUC__)
+    return __builtin_popcountl(word);
+#else
+    register int count = 0;
+    for (; word != 0; word &= word - 1)
+        ++count;
+    return count;
+#endif
+}
+
+/**
+ * Finds the lowest set bit of a word.
+ * @param word a non-zero word.
+ * @return the index of its lowest set bit.
+ */
+static int lowest_bit(unsigned long word) {
+#if defined(__GNUC__)
+    return __builtin_ctzl(word);
+#else
+    register int index = 0;
+    for (; (word & 1UL) == 0; word >>= 1)
+        ++index;
+    return index;
+#endif
+}
+
+/**
+ * Initialize a new bitset sparse matrix, which keeps a bit for every value of a 0/1 matrix.
+ * @param n the dimension of the matrix.
+ * @return a pointer to a sparse matrix structure, implemented by a bit matrix.
+ */
+spmat *spmat_allocate_bitset(int n) {
+    register spmat *mat = malloc(sizeof(spmat));
+    register bitset *rows = malloc(sizeof(bitset));
+    assertMemoryAllocation(mat);
+    assertMemoryAllocation(rows);
+    rows->words = (n + WORD_BITS - 1) / WORD_BITS;
+    rows->bits = calloc((size_t) n * rows->words + 1, sizeof(unsigned long));
+    rows->degrees = malloc((n + 1) * sizeof(int));
+    assertMemoryAllocation(rows->bits);
+    assertMemoryAllocation(rows->degrees);
+    mat->n = n;
+    mat->add_row = bitset_add_row;
+    mat->free = bitset_free;
+    mat->mult = bitset_mult;
+    mat->get = bitset_get;
+    mat->private = rows;
+    return mat;
+}
+
+/**
+ * Given a bitset sparse matrix, this function inserts a given row as the i'th row.
+ * Every non-zero value of the row should be 1.
+ * @param A a pointer to the sparse matrix.
+ * @param row a pointer to the row base address.
+ * @param i the inserted row's index.
+ */
+void bitset_add_row(struct _spmat *A, const double *row, int i) {
+    register bitset *rows = (bitset *) A->private;
+    register unsigned long *bits = rows->bits + (size_t) i * rows->words;
+    register int j;
+    rows->degrees[i] = 0;
+    for (j = 0; j < A->n; ++j) {
+        if (row[j] != 0) {
+            assertBooleanStatementIsTrue(row[j] == 1);
+            bits[j / WORD_BITS] |= 1UL << (j % WORD_BITS);
+            ++rows->degrees[i];
+        }
+    }
+}
+
+/**
+ * Frees up every resource that has been dynamically allocated
+ * by a bitset sparse matrix.
+ * @param A a pointer to the bitset sparse matrix.
+ */
+void bitset_free(struct _spmat *A) {
+    register bitset *rows;
+    assertMemoryAllocation(A);
+    rows = (bitset *) A->private;
+    free(rows->bits);
+    free(rows->degrees);
+    free(rows);
+    free(A);
+}
+
+/**
+ * Multiplies a bitset sparse matrix by a given vector.
+ * When every entry of v is +1 or -1, row i gives 2 * |row i AND positives| - degree(i), counted a word at a time.
+ * Otherwise the set bits of every row are visited in increasing column order, as in the other formats.
+ * @param A a bitset sparse matrix, of capacity n by n, to be multiplied.
+ * @param v a column vector of capacity n to be multiplied.
+ * @param result a new empty or arbitrary vector of capacity n, to be filled with the multiplication result.
+ */
+void bitset_mult(const struct _spmat *A, const double *v, double *result) {
+    register bitset *rows = (bitset *) A->private;
+    register const unsigned long *bits;
+    register unsigned long word;
+    register int i, j, w, isSigns = 1, count;
+    register double sum;
+    unsigned long *positives;
+
+    for (j = 0; j < A->n && isSigns; ++j)
+        isSigns = v[j] == 1 || v[j] == -1;
+
+    if (isSigns) {
+        positives = calloc(rows->words + 1, sizeof(unsigned long));
+        assertMemoryAllocation(positives);
+        for (j = 0; j < A->n; ++j) {
+            if (v[j] == 1)
+                positives[j / WORD_BITS] |= 1UL << (j % WORD_BITS);
+        }
+        for (i = 0; i < A->n; ++i) {
+            bits = rows->bits + (size_t) i * rows->words;
+            count = 0;
+            for (w = 0; w < rows->words; ++w)
+                count += count_bits(bits[w] & positives[w]);
+            result[i] = 2 * count - rows->degrees[i];
+        }
+        free(positives);
+        return;
+    }
+
+    for (i = 0; i < A->n; ++i) {
+        bits = rows->bits + (size_t) i * rows->words;
+        sum = 0;
+        for (w = 0; w < rows->words; ++w) {
+            for (word = bits[w]; word != 0; word &= word - 1)
+                sum += v[w * WORD_BITS + lowest_bit(word)];
+        }
+        result[i] = sum;
+    }
+}
+
+/**
+ * Finds a value of a bitset sparse matrix.
+ * @param A a bitset sparse matrix.
+ * @param i the row index.
+ * @param j the column index.
+ * @return the value A[i][j] (0 or 1).
+ */
+double bitset_get(const struct _spmat *A, int i, int j) {
+    register bitset *rows = (bitset *) A->private;
+    return (rows->bits[(size_t) i * rows->words + j / WORD_BITS] >> (j % WORD_BITS)) & 1UL;
+}
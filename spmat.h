@@ -15,6 +15,9 @@ typedef struct _spmat {
     /* Multiplies matrix A by vector v, into result (result is pre-allocated) */
     void (*mult)(const struct _spmat *A, const double *v, double *result);
 
+    /* Returns the value A[i][j] */
+    double (*get)(const struct _spmat *A, int i, int j);
+
     /* Private field for inner implementation.
      * Should not be read or modified externally */
     void *private;
@@ -25,12 +28,76 @@ struct linked_list {
     double value;
     int colind;
     struct linked_list *next;
-} linked_list;
+};
 typedef struct linked_list node;
 typedef node *nodeRef;
 
 /* Allocates a new linked-lists sparse matrix of capacity n */
 spmat *spmat_allocate_list(int n);
 
+/* array (compressed sparse row) implementation starts here */
+typedef struct _csr {
+    double *values;
+    int *colind;
+    /* row i occupies the entries rowptr[i] .. rowptr[i + 1] - 1 of values and colind */
+    int *rowptr;
+    /* number of values the arrays can hold */
+    int capacity;
+} csr;
+
+/* Allocates a new arrays sparse matrix of capacity n, with nnz non-zero values */
+spmat *spmat_allocate_array(int n, int nnz);
+
+/* symmetric implementation starts here.
+ * Only the upper triangle (j >= i) of a symmetric matrix is kept, in the arrays format,
+ * so every off-diagonal value is stored once. */
+
+/* Allocates a new symmetric sparse matrix of capacity n,
+ * with room for nnz values of the upper triangle to begin with */
+spmat *spmat_allocate_symmetric(int n, int nnz);
+
+/* compressed implementation starts here.
+ * Keeps only the pattern of a 0/1 matrix: the columns of every row are stored as the gaps between them,
+ * each gap in a variable number of bytes (7 bits per byte), and decoded on the fly by mult. */
+
+/* Allocates a new compressed sparse matrix of capacity n, with room for the given number of bytes to begin with */
+spmat *spmat_allocate_compressed(int n, int bytes);
+
+/* sliced ELLPACK (SELL-C-sigma) implementation starts here.
+ * Rows are sorted by length inside windows of sigma rows, and cut into chunks of C rows.
+ * Every chunk is padded to its longest row and stored column-major, so the C rows of a chunk are multiplied
+ * together, one value of each per step, which the compiler can map to SIMD lanes.
+ * The format is built once the last row is added. */
+
+/* the largest supported chunk height */
+#define SELL_MAX_CHUNK_HEIGHT 16
+/* a sorting window of a few hundred rows evens out the chunks, while keeping most rows near their neighbors */
+#define SELL_DEFAULT_SIGMA 256
+
+/* Returns the chunk height matching the SIMD width (in doubles) of the running processor */
+int spmat_sell_chunk_height();
+
+/* Allocates a new sliced ELLPACK sparse matrix of capacity n, with the given chunk height and sorting window */
+spmat *spmat_allocate_sell(int n, int chunkHeight, int sigma);
+
+/* merge-path implementation starts here.
+ * The arrays format, multiplied by several threads which get equal shares of chunks of rows plus non-zero values.
+ * The chunks are cut at fixed steps of the merge path, whatever the number of threads, so a long row may be shared
+ * by several chunks, whose partial sums are added in the order of the chunks once all the threads finish.
+ * The product is therefore the same, bit for bit, for every number of threads. */
+
+/* the rows plus non-zero values of a chunk, smaller matrices use fewer threads */
+#define MERGE_PATH_CHUNK 16384
+
+/* Allocates a new merge-path sparse matrix of capacity n, multiplied by up to the given number of threads */
+spmat *spmat_allocate_merge_path(int n, int threads);
+
+/* bitset implementation starts here.
+ * Keeps a 0/1 matrix as a bit per value, which is smaller than the lists once about 1 in 200 values is set.
+ * A vector of +1 and -1 entries is multiplied by counting the bits of every row which meet its +1 entries. */
+
+/* Allocates a new bitset sparse matrix of capacity n */
+spmat *spmat_allocate_bitset(int n);
+
 
 #endif
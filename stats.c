@@ -0,0 +1,179 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdlib.h>
+#include <time.h>
+#include "stats.h"
+#include "ErrorHandler.h"
+
+#ifdef CLUSTER_STATS
+
+static const char *phaseNames[STATS_PHASES_COUNT] = {
+        "load", "division", "submatrix", "eigen", "refinement", "exact", "output"
+};
+
+static const char *counterNames[STATS_COUNTERS_COUNT] = {
+        "groups", "splits_accepted", "dense_splits", "exact_splits", "rejected_eigenvalue", "rejected_modularity",
+        "rejected_precheck", "power_iterations", "mat_vecs", "refinement_passes", "deadline_groups", "deadline_vertices"
+};
+
+/* statistics of a single depth of the bisection tree */
+typedef struct _depthStats {
+    double seconds[STATS_PHASES_COUNT];
+    long counters[STATS_COUNTERS_COUNT];
+} DepthStats;
+
+typedef struct _runStats {
+    double phaseStart[STATS_PHASES_COUNT];
+    double seconds[STATS_PHASES_COUNT];
+    long calls[STATS_PHASES_COUNT];
+    long counters[STATS_COUNTERS_COUNT];
+    /* whether a phase was ever timed with respect to a depth */
+    char perDepth[STATS_PHASES_COUNT];
+    /* number of depths which are allocated / were reached so far */
+    int depthsCapacity;
+    int depthsCount;
+    DepthStats *depths;
+} RunStats;
+
+static RunStats stats;
+
+/**
+ * Read the monotonic clock.
+ * @return the current time in seconds, from an arbitrary starting point.
+ */
+static double statsNow() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
+
+/**
+ * Get the statistics of a given depth, allocating it if it was not reached before.
+ * @param depth depth in the bisection tree (0 is the root).
+ * @return the statistics of that depth.
+ */
+static DepthStats *getDepthStats(int depth) {
+    int i, j;
+    if (depth >= stats.depthsCapacity) {
+        i = stats.depthsCapacity;
+        stats.depthsCapacity = depth + 1 > 2 * stats.depthsCapacity ? depth + 1 : 2 * stats.depthsCapacity;
+        stats.depths = realloc(stats.depths, stats.depthsCapacity * sizeof(DepthStats));
+        assertMemoryAllocation(stats.depths);
+        for (; i < stats.depthsCapacity; ++i) {
+            for (j = 0; j < STATS_PHASES_COUNT; ++j)
+                stats.depths[i].seconds[j] = 0;
+            for (j = 0; j < STATS_COUNTERS_COUNT; ++j)
+                stats.depths[i].counters[j] = 0;
+        }
+    }
+    if (depth >= stats.depthsCount) {
+        stats.depthsCount = depth + 1;
+    }
+    return stats.depths + depth;
+}
+
+/**
+ * Clear every timer and counter.
+ */
+void statsReset() {
+    int i;
+    for (i = 0; i < STATS_PHASES_COUNT; ++i) {
+        stats.seconds[i] = 0;
+        stats.calls[i] = 0;
+        stats.perDepth[i] = 0;
+    }
+    for (i = 0; i < STATS_COUNTERS_COUNT; ++i) {
+        stats.counters[i] = 0;
+    }
+    free(stats.depths);
+    stats.depths = NULL;
+    stats.depthsCapacity = 0;
+    stats.depthsCount = 0;
+}
+
+/**
+ * Start timing a phase.
+ * @param phase the phase that starts now.
+ */
+void statsStartPhase(StatsPhase phase) {
+    stats.phaseStart[phase] = statsNow();
+}
+
+/**
+ * Stop timing a phase, which was started by statsStartPhase.
+ * @param phase the phase that ends now.
+ * @param depth the depth in the bisection tree the phase belongs to, or -1 if it is not related to a depth.
+ */
+void statsStopPhase(StatsPhase phase, int depth) {
+    double elapsed = statsNow() - stats.phaseStart[phase];
+    stats.seconds[phase] += elapsed;
+    ++stats.calls[phase];
+    if (depth >= 0) {
+        stats.perDepth[phase] = 1;
+        getDepthStats(depth)->seconds[phase] += elapsed;
+    }
+}
+
+/**
+ * Increase a counter.
+ * @param counter the counter to increase.
+ * @param depth the depth in the bisection tree the event belongs to, or -1 if it is not related to a depth.
+ * @param amount the amount to add.
+ */
+void statsCount(StatsCounter counter, int depth, long amount) {
+    stats.counters[counter] += amount;
+    if (depth >= 0) {
+        getDepthStats(depth)->counters[counter] += amount;
+    }
+}
+
+/**
+ * Get the total time spent in a phase.
+ * @param phase a phase.
+ * @return the time in seconds.
+ */
+double statsGetSeconds(StatsPhase phase) {
+    return stats.seconds[phase];
+}
+
+/**
+ * Get the total value of a counter.
+ * @param counter a counter.
+ * @return the counter's value.
+ */
+long statsGetCounter(StatsCounter counter) {
+    return stats.counters[counter];
+}
+
+/**
+ * Print a JSON summary of the collected statistics.
+ * @param file the file to print into.
+ */
+void statsPrintJson(FILE *file) {
+    int i, j;
+    fprintf(file, "{\n  \"phases\": {");
+    for (i = 0; i < STATS_PHASES_COUNT; ++i) {
+        fprintf(file, "%s\n    \"%s\": {\"seconds\": %.9f, \"calls\": %ld}", i > 0 ? "," : "", phaseNames[i],
+                stats.seconds[i], stats.calls[i]);
+    }
+    fprintf(file, "\n  },\n  \"counters\": {");
+    for (i = 0; i < STATS_COUNTERS_COUNT; ++i) {
+        fprintf(file, "%s\n    \"%s\": %ld", i > 0 ? "," : "", counterNames[i], stats.counters[i]);
+    }
+    fprintf(file, "\n  },\n  \"depths\": [");
+    for (i = 0; i < stats.depthsCount; ++i) {
+        fprintf(file, "%s\n    {\"depth\": %d", i > 0 ? "," : "", i);
+        for (j = 0; j < STATS_PHASES_COUNT; ++j) {
+            if (stats.perDepth[j]) {
+                fprintf(file, ", \"%s_seconds\": %.9f", phaseNames[j], stats.depths[i].seconds[j]);
+            }
+        }
+        for (j = 0; j < STATS_COUNTERS_COUNT; ++j) {
+            fprintf(file, ", \"%s\": %ld", counterNames[j], stats.depths[i].counters[j]);
+        }
+        fprintf(file, "}");
+    }
+    fprintf(file, "\n  ]\n}\n");
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef CLUSTER_STATS_H
+#define CLUSTER_STATS_H
+
+#include <stdio.h>
+
+/* Timed phases of a run. */
+typedef enum _statsPhase {
+    STATS_PHASE_LOAD,
+    STATS_PHASE_DIVISION,
+    STATS_PHASE_SUBMATRIX,
+    STATS_PHASE_EIGEN,
+    STATS_PHASE_REFINEMENT,
+    STATS_PHASE_EXACT,
+    STATS_PHASE_OUTPUT,
+    STATS_PHASES_COUNT
+} StatsPhase;
+
+/* Event counters, kept both in total and per bisection-tree depth. */
+typedef enum _statsCounter {
+    STATS_COUNTER_GROUPS,
+    STATS_COUNTER_SPLITS_ACCEPTED,
+    /* the accepted splits of the dense and the exact engines (counted in the accepted splits too), which take no
+     * multiplications by the sparse matrices */
+    STATS_COUNTER_DENSE_SPLITS,
+    STATS_COUNTER_EXACT_SPLITS,
+    STATS_COUNTER_REJECTED_EIGENVALUE,
+    STATS_COUNTER_REJECTED_MODULARITY,
+    STATS_COUNTER_REJECTED_PRECHECK,
+    STATS_COUNTER_POWER_ITERATIONS,
+    STATS_COUNTER_MAT_VECS,
+    STATS_COUNTER_REFINEMENT_PASSES,
+    /* groups (and their vertices) left undivided when the deadline passed */
+    STATS_COUNTER_DEADLINE_GROUPS,
+    STATS_COUNTER_DEADLINE_VERTICES,
+    STATS_COUNTERS_COUNT
+} StatsCounter;
+
+/*
+ * The instrumentation is compiled only when CLUSTER_STATS is defined.
+ * Otherwise every STATS_* macro expands to a no-op, and nothing of this module is linked in.
+ */
+#ifdef CLUSTER_STATS
+
+void statsReset();
+
+void statsStartPhase(StatsPhase phase);
+
+void statsStopPhase(StatsPhase phase, int depth);
+
+void statsCount(StatsCounter counter, int depth, long amount);
+
+void statsPrintJson(FILE *file);
+
+double statsGetSeconds(StatsPhase phase);
+
+long statsGetCounter(StatsCounter counter);
+
+#define STATS_RESET() statsReset()
+#define STATS_START(phase) statsStartPhase(phase)
+#define STATS_STOP(phase, depth) statsStopPhase((phase), (depth))
+#define STATS_COUNT(counter, depth, amount) statsCount((counter), (depth), (amount))
+
+#else
+
+#define STATS_RESET() ((void) 0)
+#define STATS_START(phase) ((void) 0)
+#define STATS_STOP(phase, depth) ((void) 0)
+#define STATS_COUNT(counter, depth, amount) ((void) 0)
+
+#endif
+
+#endif
@@ -0,0 +1,303 @@
+/**
+ * Benchmark suite for the cluster project.
+ *
+ * Times the load, eigen-solve, refinement and output phases separately (through the stats module),
+ * over the graphs of tests/neoTests and over synthetic planted-partition graphs of growing size.
+ * Every case is run several times, and the median and 95th percentile of each phase are reported,
+ * along with the splits of every engine, the mat-vecs per split of the sparse engine and the peak RSS, as a JSON array.
+ * Every case runs in a child process of its own, so its peak RSS is not the high-water mark of the cases before it.
+ *
+ * usage: bench [--graphs DIR] [--repeat N] [--min-vertices N] [--max-vertices N] [--output FILE] [--batch N]
+ * Run it from the repository root, or point --graphs to the neoTests directory.
+ * With --batch, the eigenproblems of up to N groups of the sparse engine are solved together (see batch.h).
+ */
+
+#define _XOPEN_SOURCE 500
+/* for wait4 */
+#define _DEFAULT_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "../../graph.h"
+#include "../../division.h"
+#include "../../output.h"
+#include "../../ErrorHandler.h"
+#include "../../stats.h"
+#include "../../rng.h"
+
+#ifndef CLUSTER_STATS
+#error "The benchmark reads the stats module, build it with CLUSTER_STATS defined"
+#endif
+
+#define BENCH_SEED 12345
+#define COMMUNITY_SIZE 50
+#define INNER_DEGREE 12
+#define OUTER_DEGREE 2
+
+static char *neoGraphs[] = {
+        "3c", "30c", "30a", "300c", "300a", "20-30c", "20-30a", "60-100c", "60-100a",
+        "100graph-mudulu30", "1000graph-mudulu35"
+};
+
+/* the measured phases, in the order they are reported */
+static const StatsPhase benchPhases[] = {
+        STATS_PHASE_LOAD, STATS_PHASE_SUBMATRIX, STATS_PHASE_EIGEN, STATS_PHASE_REFINEMENT, STATS_PHASE_OUTPUT,
+        STATS_PHASE_DIVISION
+};
+static const char *benchPhaseNames[] = {"load", "submatrix", "eigen", "refinement", "output", "division"};
+#define BENCH_PHASES_COUNT 6
+
+static int compareInts(const void *a, const void *b) {
+    int x = *(const int *) a, y = *(const int *) b;
+    return (x > y) - (x < y);
+}
+
+static int compareDoubles(const void *a, const void *b) {
+    double x = *(const double *) a, y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Writes a planted-partition graph in the input format of the cluster program.
+ * The vertices are split into communities of COMMUNITY_SIZE consecutive vertices. Every vertex gets
+ * INNER_DEGREE random edges inside its community and OUTER_DEGREE random edges to the rest of the graph.
+ * @param path the path of the input file to create.
+ * @param n the number of vertices.
+ */
+static void writePlantedPartitionGraph(char *path, int n) {
+    int perVertex = INNER_DEGREE + OUTER_DEGREE;
+    int *edges = malloc(2 * (size_t) n * perVertex * sizeof(int));
+    int *degrees = calloc(n, sizeof(int));
+    int *offsets = malloc((n + 1) * sizeof(int));
+    int *neighbors, *fill;
+    int i, j, k, u, v, communityStart, communitySize, edgesCount = 0;
+    FILE *file;
+    Rng rng;
+    assertMemoryAllocation(edges);
+    assertMemoryAllocation(degrees);
+    assertMemoryAllocation(offsets);
+
+    /* a fixed seed, so the synthetic graphs are identical on every run and platform */
+    seedRng(&rng, BENCH_SEED, n, 0);
+    for (u = 0; u < n; ++u) {
+        communityStart = u - u % COMMUNITY_SIZE;
+        communitySize = n - communityStart < COMMUNITY_SIZE ? n - communityStart : COMMUNITY_SIZE;
+        for (k = 0; k < perVertex; ++k) {
+            if (k < INNER_DEGREE) {
+                v = communityStart + (int) (nextRandom(&rng) % communitySize);
+            } else {
+                v = (int) (nextRandom(&rng) % n);
+            }
+            if (u != v) {
+                edges[2 * edgesCount] = u;
+                edges[2 * edgesCount + 1] = v;
+                ++degrees[u];
+                ++degrees[v];
+                ++edgesCount;
+            }
+        }
+    }
+
+    /* bucket both directions of every edge by their source vertex */
+    offsets[0] = 0;
+    for (i = 0; i < n; ++i) {
+        offsets[i + 1] = offsets[i] + degrees[i];
+    }
+    neighbors = malloc(offsets[n] * sizeof(int) + 1);
+    fill = malloc(n * sizeof(int));
+    assertMemoryAllocation(neighbors);
+    assertMemoryAllocation(fill);
+    memcpy(fill, offsets, n * sizeof(int));
+    for (i = 0; i < edgesCount; ++i) {
+        u = edges[2 * i];
+        v = edges[2 * i + 1];
+        neighbors[fill[u]++] = v;
+        neighbors[fill[v]++] = u;
+    }
+
+    file = fopen(path, "wb");
+    assertFileOpen(file, path);
+    assertFileWrite(fwrite(&n, sizeof(int), 1, file), 1, path);
+    for (i = 0; i < n; ++i) {
+        /* sort and remove parallel edges */
+        qsort(neighbors + offsets[i], degrees[i], sizeof(int), compareInts);
+        k = 0;
+        for (j = 0; j < degrees[i]; ++j) {
+            if (k == 0 || neighbors[offsets[i] + j] != neighbors[offsets[i] + k - 1]) {
+                neighbors[offsets[i] + k++] = neighbors[offsets[i] + j];
+            }
+        }
+        assertFileWrite(fwrite(&k, sizeof(int), 1, file), 1, path);
+        assertFileWrite(fwrite(neighbors + offsets[i], sizeof(int), k, file), k, path);
+    }
+    fclose(file);
+
+    free(fill);
+    free(neighbors);
+    free(offsets);
+    free(degrees);
+    free(edges);
+}
+
+/**
+ * Get a percentile of a sample, using the nearest-rank method.
+ * @param values the sample, will be sorted.
+ * @param count the sample size.
+ * @param percentile a number between 0 and 100.
+ * @return the percentile value.
+ */
+static double getPercentile(double *values, int count, double percentile) {
+    int rank = (int) (percentile / 100 * count + 0.999999);
+    qsort(values, count, sizeof(double), compareDoubles);
+    if (rank < 1) {
+        rank = 1;
+    }
+    return values[rank - 1];
+}
+
+/**
+ * Runs the whole clustering process on an input file several times, and reports the results.
+ * The runs are made by a child process, which reports all the results but its peak RSS, measured once it exits.
+ * @param output the file the JSON results are written to.
+ * @param name the name of the case.
+ * @param inputPath the path of the input graph.
+ * @param repeat the number of runs.
+ * @param batchSize the number of groups of the sparse engine whose eigenproblems are solved together.
+ * @param isFirst whether it is the first reported case.
+ */
+static void benchFile(FILE *output, char *name, char *inputPath, int repeat, int batchSize, int isFirst) {
+    double *times = malloc(BENCH_PHASES_COUNT * repeat * sizeof(double));
+    double matVecsPerSplit = 0;
+    char outputPath[] = "benchOut";
+    Graph *G;
+    LinkedList *groupsLst;
+    DivisionSettings settings;
+    struct rusage usage;
+    long sparseSplits = 0;
+    pid_t child;
+    int run, i, status, n = 0, groupsCount = 0;
+    assertMemoryAllocation(times);
+    /* the child inherits the buffered output, which would be written twice */
+    fflush(output);
+    child = fork();
+    assertBooleanStatementIsTrue(child >= 0);
+    if (child > 0) {
+        free(times);
+        assertBooleanStatementIsTrue(wait4(child, &status, 0, &usage) == child);
+        assertBooleanStatementIsTrue(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        fprintf(output, ", \"peak_rss_kb\": %ld}", usage.ru_maxrss);
+        fflush(output);
+        return;
+    }
+    initDivisionSettings(&settings);
+    settings.seed = BENCH_SEED;
+    settings.batchSize = batchSize;
+
+    for (run = 0; run < repeat; ++run) {
+        STATS_RESET();
+        STATS_START(STATS_PHASE_LOAD);
+        G = constructGraphFromInput(inputPath);
+        STATS_STOP(STATS_PHASE_LOAD, -1);
+        groupsLst = divisionAlgorithm(G, &settings);
+        STATS_START(STATS_PHASE_OUTPUT);
+        saveOutputToFile(groupsLst, outputPath, 0, 0);
+        STATS_STOP(STATS_PHASE_OUTPUT, -1);
+
+        for (i = 0; i < BENCH_PHASES_COUNT; ++i) {
+            times[i * repeat + run] = statsGetSeconds(benchPhases[i]);
+        }
+        n = G->n;
+        groupsCount = groupsLst->length;
+        /* the mat-vecs are all of the sparse engine, so they are divided by its splits alone */
+        sparseSplits = statsGetCounter(STATS_COUNTER_SPLITS_ACCEPTED) - statsGetCounter(STATS_COUNTER_DENSE_SPLITS) -
+                       statsGetCounter(STATS_COUNTER_EXACT_SPLITS);
+        matVecsPerSplit = sparseSplits == 0 ? 0 : (double) statsGetCounter(STATS_COUNTER_MAT_VECS) / sparseSplits;
+        deepFreeGroupList(groupsLst);
+        destroyGraph(G);
+    }
+    remove(outputPath);
+
+    fprintf(output, "%s  {\"name\": \"%s\", \"vertices\": %d, \"groups\": %d, \"runs\": %d", isFirst ? "" : ",\n",
+            name, n, groupsCount, repeat);
+    for (i = 0; i < BENCH_PHASES_COUNT; ++i) {
+        fprintf(output, ", \"%s_median\": %.6f, \"%s_p95\": %.6f",
+                benchPhaseNames[i], getPercentile(times + i * repeat, repeat, 50),
+                benchPhaseNames[i], getPercentile(times + i * repeat, repeat, 95));
+    }
+    fprintf(output, ", \"splits\": %ld, \"sparse_splits\": %ld, \"dense_splits\": %ld, \"exact_splits\": %ld",
+            statsGetCounter(STATS_COUNTER_SPLITS_ACCEPTED), sparseSplits, statsGetCounter(STATS_COUNTER_DENSE_SPLITS),
+            statsGetCounter(STATS_COUNTER_EXACT_SPLITS));
+    if (sparseSplits > 0) {
+        fprintf(output, ", \"mat_vecs_per_split\": %.1f", matVecsPerSplit);
+    } else {
+        fprintf(output, ", \"mat_vecs_per_split\": null");
+    }
+    fflush(output);
+    free(times);
+    exit(0);
+}
+
+int main(int argc, char **argv) {
+    char *graphsDir = "tests/neoTests";
+    char *outputPath = NULL;
+    char path[1024], name[64], syntheticPath[] = "benchGraph";
+    int repeat = 5, minVertices = 1000, maxVertices = 1000, batchSize = 0, n, i, isFirst = 1;
+    FILE *output = stdout;
+
+    for (i = 1; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "--graphs") == 0) {
+            graphsDir = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--repeat") == 0) {
+            repeat = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--min-vertices") == 0) {
+            minVertices = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--max-vertices") == 0) {
+            maxVertices = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--output") == 0) {
+            outputPath = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--batch") == 0) {
+            batchSize = atoi(argv[++i]);
+        } else {
+            throw("usage: bench [--graphs DIR] [--repeat N] [--min-vertices N] [--max-vertices N] [--output FILE] "
+                  "[--batch N]\n");
+        }
+    }
+    assertBooleanStatementIsTrue(repeat > 0 && batchSize >= 0);
+    /* the synthetic sizes grow tenfold from the smallest one */
+    if (minVertices < 1) {
+        throw("The smallest number of vertices should be at least 1");
+    }
+    if (outputPath != NULL) {
+        output = fopen(outputPath, "w");
+        assertFileOpen(output, outputPath);
+    }
+
+    fprintf(output, "[\n");
+    for (i = 0; i < (int) (sizeof(neoGraphs) / sizeof(char *)); ++i) {
+        sprintf(path, "%.1000s/%s", graphsDir, neoGraphs[i]);
+        benchFile(output, neoGraphs[i], path, repeat, batchSize, isFirst);
+        isFirst = 0;
+    }
+    for (n = minVertices; n <= maxVertices; n *= 10) {
+        sprintf(name, "planted-%d", n);
+        writePlantedPartitionGraph(syntheticPath, n);
+        benchFile(output, name, syntheticPath, repeat, batchSize, isFirst);
+        remove(syntheticPath);
+        /* the next size would overflow */
+        if (n > maxVertices / 10) {
+            break;
+        }
+    }
+    fprintf(output, "\n]\n");
+
+    if (outputPath != NULL) {
+        fclose(output);
+    }
+    return 0;
+}
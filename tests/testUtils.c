@@ -259,6 +259,7 @@ Graph *constructGraphFromMatrix(double *adjMatrix, int n) {
     assertMemoryAllocation(G->degrees);
     G->n = n;
     G->degreeSum = 0;
+    G->originalIndices = NULL;
     G->adjMat = spmat_allocate_list(n);
 
     for (i = 0; i < n; ++i) {
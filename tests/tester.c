@@ -1,7 +1,23 @@
+#define _POSIX_C_SOURCE 200112L
+
 #include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include "tester.h"
 #include "../ErrorHandler.h"
 #include "testUtils.h"
+#include "../dense.h"
+#include "../exact.h"
+#include "../multiway.h"
+#include "../twins.h"
+#include "../ensemble.h"
+#include "../checkpoint.h"
+#include "../output.h"
+#include "../server.h"
 #include <time.h>
 #include <stdio.h>
 #include <math.h>
@@ -240,7 +256,10 @@ void destroyTestGraph(testGraph *TG) {
  * @return 0-if the test fails. 1-otherwise.
  */
 char performTest(testGraph *TG) {
-    LinkedList *result = divisionAlgorithm(TG->G);
+    DivisionSettings settings;
+    LinkedList *result;
+    initDivisionSettings(&settings);
+    result = divisionAlgorithm(TG->G, &settings);
     return checkGroupListsEquality(result, TG);
 }
 
@@ -449,8 +468,712 @@ void printResultsFromOutputFile(char *output_file_path) {
     assert(fabs(modularity - (aModularity + bModularity)) < 0.001);
 }*/
 
+/**
+ * Compares the exact solver with an exhaustive search that evaluates every division of a random graph
+ * through the sparse modularity machinery (calculateModularity).
+ * @return 0-if the test fails. 1-otherwise.
+ */
+char testExactDivision() {
+    int n = 12, i, j;
+    unsigned long mask;
+    double *adjMatrix = calloc(n * n, sizeof(double));
+    double *s = malloc(n * sizeof(double));
+    double *rowSums = malloc(n * sizeof(double));
+    double *B, exactModularity, modularity, bestModularity = 0;
+    unsigned int numberOfPositiveVertices;
+    VerticesGroup *group = createVerticesGroup(n);
+    Graph *G;
+    assertMemoryAllocation(adjMatrix);
+    assertMemoryAllocation(s);
+    assertMemoryAllocation(rowSums);
+
+    for (i = 0; i < n; ++i) {
+        addVertexToGroup(group, i);
+        for (j = 0; j < i; ++j) {
+            adjMatrix[i * n + j] = adjMatrix[j * n + i] = drand(0, 100) < 35;
+        }
+    }
+    G = constructGraphFromMatrix(adjMatrix, n);
+    B = buildDenseModularityMatrix(G, group, rowSums);
+    exactModularity = exactMaximizeModularity(B, rowSums, n, s, &numberOfPositiveVertices);
+
+    calculateModularitySubMatrix(G, group);
+    for (mask = 0; mask < (1UL << n); ++mask) {
+        for (i = 0; i < n; ++i) {
+            s[i] = ((mask >> i) & 1UL) ? 1 : -1;
+        }
+        modularity = calculateModularity(G, group, s);
+        if (modularity > bestModularity) {
+            bestModularity = modularity;
+        }
+    }
+    freeVerticesGroupModularitySubMatrix(group);
+    printf("Exact modularity: %f\nExhaustive modularity: %f\n", exactModularity, bestModularity);
+
+    free(B);
+    free(rowSums);
+    free(s);
+    free(adjMatrix);
+    freeVerticesGroup(group);
+    destroyGraph(G);
+    return fabs(exactModularity - bestModularity) < 1e-9;
+}
+
+/**
+ * Compares the arrays, symmetric, compressed, sliced ELLPACK, merge-path and bitset sparse formats with the lists
+ * format, on a random symmetric 0/1 matrix:
+ * the products with a random vector and every value should agree.
+ * @return 0-if the test fails. 1-otherwise.
+ */
+char testSparseFormats() {
+    int n = 300, i, j, k;
+    double *matrix = calloc(n * n, sizeof(double));
+    double *v = malloc(n * sizeof(double));
+    double *results = malloc(7 * n * sizeof(double));
+    double *signs = malloc(n * sizeof(double));
+    spmat *formats[7];
+    char result = 1;
+    assertMemoryAllocation(matrix);
+    assertMemoryAllocation(v);
+    assertMemoryAllocation(results);
+    assertMemoryAllocation(signs);
+
+    for (i = 0; i < n; ++i) {
+        v[i] = drand(-1, 1);
+        signs[i] = drand(0, 1) < 0.5 ? 1 : -1;
+        for (j = 0; j <= i; ++j) {
+            if (drand(0, 100) < 5) {
+                matrix[i * n + j] = matrix[j * n + i] = 1;
+            }
+        }
+    }
+    /* a gap which takes more than one byte in the compressed format */
+    matrix[n - 1] = matrix[(n - 1) * n] = 1;
+    formats[0] = spmat_allocate_list(n);
+    formats[1] = spmat_allocate_array(n, 1);
+    formats[2] = spmat_allocate_symmetric(n, 1);
+    formats[3] = spmat_allocate_compressed(n, 1);
+    formats[4] = spmat_allocate_sell(n, 8, 32);
+    formats[5] = spmat_allocate_merge_path(n, 4);
+    formats[6] = spmat_allocate_bitset(n);
+    for (k = 0; k < 7; ++k) {
+        for (i = 0; i < n; ++i) {
+            formats[k]->add_row(formats[k], matrix + i * n, i);
+        }
+        formats[k]->mult(formats[k], v, results + k * n);
+    }
+    for (k = 1; k < 7; ++k) {
+        for (i = 0; i < n; ++i) {
+            if (fabs(results[i] - results[k * n + i]) > 1e-12) {
+                result = 0;
+            }
+            for (j = 0; j < n; ++j) {
+                if (formats[k]->get(formats[k], i, j) != formats[0]->get(formats[0], i, j) ||
+                    formats[0]->get(formats[0], i, j) != matrix[i * n + j]) {
+                    result = 0;
+                }
+            }
+        }
+    }
+
+    /* the bitset format counts bits when multiplied by signs, as in the refinement */
+    formats[0]->mult(formats[0], signs, results);
+    formats[6]->mult(formats[6], signs, results + n);
+    for (i = 0; i < n; ++i) {
+        if (results[i] != results[n + i]) {
+            result = 0;
+        }
+    }
+
+    for (k = 0; k < 7; ++k) {
+        formats[k]->free(formats[k]);
+    }
+    free(signs);
+    free(results);
+    free(v);
+    free(matrix);
+    return result;
+}
+
+/**
+ * Compares the merge-path format with the lists format on a matrix with a few full (hub) rows,
+ * large enough for several threads, so hub rows are shared between threads.
+ * The products of every number of threads should be exactly the same.
+ * @return 0-if the test fails. 1-otherwise.
+ */
+char testMergePathSharedRows() {
+    int n = 8000, hubs = 6, i, j, t;
+    double *row = malloc(n * sizeof(double));
+    double *v = malloc(n * sizeof(double));
+    double *expected = malloc(n * sizeof(double));
+    double *results = malloc(n * sizeof(double));
+    double *single = malloc(n * sizeof(double));
+    spmat *lists = spmat_allocate_list(n), *paths[4];
+    char result = 1;
+    assertMemoryAllocation(row);
+    assertMemoryAllocation(v);
+    assertMemoryAllocation(expected);
+    assertMemoryAllocation(results);
+    assertMemoryAllocation(single);
+    for (t = 0; t < 4; ++t) {
+        paths[t] = spmat_allocate_merge_path(n, t + 1);
+    }
+
+    for (i = 0; i < n; ++i) {
+        v[i] = drand(-1, 1);
+        for (j = 0; j < n; ++j) {
+            row[j] = (i < hubs || drand(0, n) < 2) ? drand(-1, 1) : 0;
+        }
+        lists->add_row(lists, row, i);
+        for (t = 0; t < 4; ++t) {
+            paths[t]->add_row(paths[t], row, i);
+        }
+    }
+    lists->mult(lists, v, expected);
+    paths[0]->mult(paths[0], v, single);
+    for (i = 0; i < n; ++i) {
+        if (fabs(expected[i] - single[i]) > 1e-9) {
+            result = 0;
+        }
+    }
+    for (t = 1; t < 4; ++t) {
+        paths[t]->mult(paths[t], v, results);
+        for (i = 0; i < n; ++i) {
+            if (results[i] != single[i]) {
+                result = 0;
+            }
+        }
+    }
+
+    lists->free(lists);
+    for (t = 0; t < 4; ++t) {
+        paths[t]->free(paths[t]);
+    }
+    free(single);
+    free(results);
+    free(expected);
+    free(v);
+    free(row);
+    return result;
+}
+
+/**
+ * Divides a ring of three cliques by two eigenvectors at once:
+ * the multi-way division should give the three cliques.
+ * @return 0-if the test fails. 1-otherwise.
+ */
+char testMultiwayDivision() {
+    int n = 24, size = 8, i, j, partsCount;
+    double *adjMatrix = calloc(n * n, sizeof(double));
+    double *s = malloc(n * sizeof(double));
+    VerticesGroup *group = createVerticesGroup(n), *parts[4];
+    DivisionSettings settings;
+    Graph *G;
+    char result;
+    assertMemoryAllocation(adjMatrix);
+    assertMemoryAllocation(s);
+
+    for (i = 0; i < n; ++i) {
+        addVertexToGroup(group, i);
+        for (j = 0; j < i; ++j) {
+            adjMatrix[i * n + j] = adjMatrix[j * n + i] = i / size == j / size;
+        }
+    }
+    for (i = 0; i < n; i += size) {
+        adjMatrix[i * n + (i + size) % n] = adjMatrix[((i + size) % n) * n + i] = 1;
+    }
+    G = constructGraphFromMatrix(adjMatrix, n);
+    initDivisionSettings(&settings);
+    settings.denseThreshold = 0;
+    settings.exactThreshold = 0;
+    settings.splitVectors = 2;
+    partsCount = multiwayDivisionAlgorithm(G, &settings, group, s, parts);
+
+    result = partsCount == 3;
+    for (i = 0; i < partsCount; ++i) {
+        result = result && parts[i]->size == size;
+        for (j = 0; j < parts[i]->size; ++j) {
+            result = result && parts[i]->verticesArr[j] / size == parts[i]->verticesArr[0] / size;
+        }
+        freeVerticesGroup(parts[i]);
+    }
+    printf("Parts: %d\n", partsCount);
+
+    free(s);
+    free(adjMatrix);
+    freeVerticesGroup(group);
+    destroyGraph(G);
+    return result;
+}
+
+/**
+ * Create a group of given vertices.
+ * @param vertices the vertices of the group.
+ * @param size the number of vertices.
+ * @param depth the depth of the group.
+ * @return the group.
+ */
+static VerticesGroup *createTestGroup(const int *vertices, int size, int depth) {
+    VerticesGroup *group = createVerticesGroup(size);
+    int i;
+    for (i = 0; i < size; ++i) {
+        addVertexToGroup(group, vertices[i]);
+    }
+    group->depth = depth;
+    return group;
+}
+
+/**
+ * Check whether two lists hold the same groups, in the same order.
+ * @return 0-if they differ. 1-otherwise.
+ */
+static char areGroupListsIdentical(LinkedList *first, LinkedList *second) {
+    LinkedListNode *x = first->first, *y = second->first;
+    VerticesGroup *a, *b;
+    int i, j;
+    if (first->length != second->length) {
+        return 0;
+    }
+    for (i = 0; i < first->length; ++i, x = x->next, y = y->next) {
+        a = x->pointer;
+        b = y->pointer;
+        if (a->depth != b->depth || a->size != b->size) {
+            return 0;
+        }
+        for (j = 0; j < a->size; ++j) {
+            if (a->verticesArr[j] != b->verticesArr[j]) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+/**
+ * Check whether loading a checkpoint fails, in a child process, as a rejected checkpoint exits.
+ * @param path path of the checkpoint file.
+ * @param n the number of vertices of the graph.
+ * @return 1-if the checkpoint is rejected. 0-otherwise.
+ */
+static char isCheckpointRejected(char *path, int n) {
+    LinkedList *P, *O;
+    unsigned long seed;
+    pid_t child;
+    int status;
+    /* the child would write the buffered output again */
+    fflush(stdout);
+    child = fork();
+    assertBooleanStatementIsTrue(child >= 0);
+    if (child == 0) {
+        assertBooleanStatementIsTrue(freopen("/dev/null", "w", stdout) != NULL);
+        P = createLinkedList();
+        O = createLinkedList();
+        loadCheckpoint(path, P, O, n, &seed);
+        exit(0);
+    }
+    assertBooleanStatementIsTrue(waitpid(child, &status, 0) == child);
+    return WIFEXITED(status) && WEXITSTATUS(status) != 0;
+}
+
+/**
+ * Saves the lists of a division to a checkpoint and loads them back, and checks that truncated checkpoints,
+ * and checkpoints of a vertex in two groups or of a group out of order, are rejected.
+ * @return 0-if the test fails. 1-otherwise.
+ */
+char testCheckpoint() {
+    int n = 10, first[] = {0, 1, 2}, second[] = {5, 7}, third[] = {3}, fourth[] = {4, 6, 8, 9};
+    int duplicate[] = {2, 4, 6, 8, 9}, unsorted[] = {4, 8, 6, 9};
+    char path[] = "testCheckpoint", badPath[] = "testCheckpointBad", result = 1, *contents;
+    unsigned long seed = (((unsigned long) 0x1234 << 16) << 16) | 0x89abcdefUL, loadedSeed = 0;
+    LinkedList *P = createLinkedList(), *O = createLinkedList(), *loadedP, *loadedO, *bad;
+    FILE *file;
+    long length;
+
+    insertItem(P, createTestGroup(first, 3, 1));
+    insertItem(P, createTestGroup(second, 2, 2));
+    insertItem(O, createTestGroup(third, 1, 2));
+    insertItem(O, createTestGroup(fourth, 4, 3));
+    saveCheckpoint(path, P, O, n, seed);
+    loadedP = createLinkedList();
+    loadedO = createLinkedList();
+    loadCheckpoint(path, loadedP, loadedO, n, &loadedSeed);
+    if (loadedSeed != seed || !areGroupListsIdentical(P, loadedP) || !areGroupListsIdentical(O, loadedO)) {
+        result = 0;
+    }
+
+    /* a checkpoint cut before its last vertex */
+    file = fopen(path, "rb");
+    assertFileOpen(file, path);
+    fseek(file, 0, SEEK_END);
+    length = ftell(file) - (long) sizeof(int);
+    rewind(file);
+    contents = malloc(length);
+    assertMemoryAllocation(contents);
+    assertFileRead(fread(contents, 1, length, file), length, path);
+    fclose(file);
+    file = fopen(badPath, "wb");
+    assertFileOpen(file, badPath);
+    assertFileWrite(fwrite(contents, 1, length, file), length, badPath);
+    fclose(file);
+    free(contents);
+    if (!isCheckpointRejected(badPath, n)) {
+        result = 0;
+    }
+
+    /* vertex 2 in two groups, and a group out of order */
+    bad = createLinkedList();
+    insertItem(bad, createTestGroup(third, 1, 2));
+    insertItem(bad, createTestGroup(duplicate, 5, 3));
+    saveCheckpoint(badPath, P, bad, n, seed);
+    if (!isCheckpointRejected(badPath, n)) {
+        result = 0;
+    }
+    deepFreeGroupList(bad);
+    bad = createLinkedList();
+    insertItem(bad, createTestGroup(third, 1, 2));
+    insertItem(bad, createTestGroup(unsorted, 4, 3));
+    saveCheckpoint(badPath, P, bad, n, seed);
+    if (!isCheckpointRejected(badPath, n)) {
+        result = 0;
+    }
+
+    remove(path);
+    remove(badPath);
+    deepFreeGroupList(bad);
+    deepFreeGroupList(P);
+    deepFreeGroupList(O);
+    deepFreeGroupList(loadedP);
+    deepFreeGroupList(loadedO);
+    return result;
+}
+
+/* the arguments of a server thread of the tester */
+typedef struct _serverThread {
+    int listener;
+    ResidentGraph *graphs;
+} serverThread;
+
+/**
+ * Run a server of a single graph, until a SERVER_SHUTDOWN request.
+ * @param argument the server (a serverThread).
+ * @return NULL
+ */
+static void *runTestServer(void *argument) {
+    serverThread *server = (serverThread *) argument;
+    runServer(server->listener, server->graphs, 1);
+    return NULL;
+}
+
+/**
+ * Connect to a server.
+ * @param path path of the server's socket.
+ * @return the connection's socket.
+ */
+static int connectToServer(char *path) {
+    struct sockaddr_un address;
+    int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+    assertBooleanStatementIsTrue(connection >= 0);
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+    assertBooleanStatementIsTrue(connect(connection, (struct sockaddr *) &address, sizeof(address)) == 0);
+    return connection;
+}
+
+/**
+ * Send a whole request to a server, and read its whole reply.
+ * @param path path of the server's socket.
+ * @param command the command of the request.
+ * @param name the name of the graph.
+ * @param nameLength the length of the name sent, which may differ from the name's.
+ * @param arguments the integers after the name.
+ * @param argumentsCount the number of integers after the name.
+ * @param reply a buffer for the reply.
+ * @param capacity the number of integers the buffer holds.
+ * @return the number of integers of the reply.
+ */
+static int requestServer(char *path, int command, char *name, int nameLength, const int *arguments,
+                         int argumentsCount, int *reply, int capacity) {
+    int connection = connectToServer(path), header[2];
+    char *position = (char *) reply;
+    size_t bytes = 0;
+    ssize_t count;
+    header[0] = command;
+    header[1] = nameLength;
+    assertBooleanStatementIsTrue(write(connection, header, sizeof(header)) == (ssize_t) sizeof(header));
+    if (nameLength > 0 && nameLength <= (int) strlen(name)) {
+        assertBooleanStatementIsTrue(write(connection, name, nameLength) == nameLength);
+    }
+    if (argumentsCount > 0) {
+        assertBooleanStatementIsTrue(write(connection, arguments, argumentsCount * sizeof(int)) ==
+                                     (ssize_t) (argumentsCount * sizeof(int)));
+    }
+    shutdown(connection, SHUT_WR);
+    while (bytes < capacity * sizeof(int) && (count = read(connection, position + bytes,
+                                                           capacity * sizeof(int) - bytes)) > 0) {
+        bytes += (size_t) count;
+    }
+    close(connection);
+    return (int) (bytes / sizeof(int));
+}
+
+/**
+ * Checks that a server does not start on a path taken by a file which is not a socket.
+ * @param path the path, in a forked child.
+ * @return 1-if the child fails. 0-otherwise.
+ */
+static char isServerSocketRejected(char *path) {
+    pid_t child;
+    int status;
+    /* the child would write the buffered output again */
+    fflush(stdout);
+    child = fork();
+    assertBooleanStatementIsTrue(child >= 0);
+    if (child == 0) {
+        assertBooleanStatementIsTrue(freopen("/dev/null", "w", stdout) != NULL);
+        openServerSocket(path);
+        exit(0);
+    }
+    assertBooleanStatementIsTrue(waitpid(child, &status, 0) == child);
+    return WIFEXITED(status) && WEXITSTATUS(status) != 0;
+}
+
+/**
+ * Runs a server of two cliques joined by an edge, and checks its replies to a division of the whole graph, a
+ * division of a subset, and bad requests, while another client is connected and idle.
+ * The socket file it leaves should be replaced by the next server, and a regular file of that path kept.
+ * @return 0-if the test fails. 1-otherwise.
+ */
+char testServer() {
+    int n = 10, size = 5, i, j, length, replyLength, reply[64], *expected;
+    int seed[2] = {5, 0}, subset[8] = {5, 0, 5, 4, 2, 0, 3, 1};
+    int outOfRange[4] = {5, 0, 1, 10}, repeated[5] = {5, 0, 2, 1, 1};
+    double *adjMatrix = calloc(n * n, sizeof(double));
+    char path[] = "testServerSocket", name[] = "cliques", result = 1;
+    DivisionSettings settings;
+    ResidentGraph graph;
+    LinkedList *groupLst;
+    serverThread server;
+    pthread_t thread;
+    int idle, command = SERVER_CLUSTER;
+    FILE *file;
+    assertMemoryAllocation(adjMatrix);
+
+    for (i = 0; i < n; ++i) {
+        for (j = 0; j < n; ++j) {
+            if (i != j && i / size == j / size) {
+                adjMatrix[i * n + j] = 1;
+            }
+        }
+    }
+    adjMatrix[(size - 1) * n + size] = adjMatrix[size * n + size - 1] = 1;
+    graph.name = name;
+    graph.G = constructGraphFromMatrix(adjMatrix, n);
+    initDivisionSettings(&settings);
+    settings.seed = 5;
+    groupLst = divisionAlgorithm(graph.G, &settings);
+    sortGroupVertices(groupLst);
+    sortGroupList(groupLst);
+    length = (int) getOutputLength(groupLst);
+    expected = malloc(length * sizeof(int));
+    assertMemoryAllocation(expected);
+    fillOutputBuffer(groupLst, expected);
+
+    server.listener = openServerSocket(path);
+    server.graphs = &graph;
+    assertBooleanStatementIsTrue(pthread_create(&thread, NULL, runTestServer, &server) == 0);
+    /* a client which sends only the command, and holds its connection open */
+    idle = connectToServer(path);
+    assertBooleanStatementIsTrue(write(idle, &command, sizeof(int)) == (ssize_t) sizeof(int));
+
+    replyLength = requestServer(path, SERVER_CLUSTER, name, strlen(name), seed, 2, reply, 64);
+    if (replyLength != 1 + length || reply[0] != SERVER_OK || memcmp(reply + 1, expected, length * sizeof(int)) != 0) {
+        result = 0;
+    }
+    /* the first clique, out of order: a clique is indivisible */
+    replyLength = requestServer(path, SERVER_CLUSTER_SUBSET, name, strlen(name), subset, 8, reply, 64);
+    if (replyLength != 8 || reply[0] != SERVER_OK || reply[1] != 1 || reply[2] != size) {
+        result = 0;
+    }
+    for (i = 0; i < size && replyLength == 8; ++i) {
+        if (reply[3 + i] != i) {
+            result = 0;
+        }
+    }
+    replyLength = requestServer(path, SERVER_CLUSTER, "other", 5, seed, 2, reply, 64);
+    if (replyLength != 1 || reply[0] != SERVER_UNKNOWN_GRAPH) {
+        result = 0;
+    }
+    replyLength = requestServer(path, 7, name, strlen(name), seed, 2, reply, 64);
+    if (replyLength != 1 || reply[0] != SERVER_BAD_REQUEST) {
+        result = 0;
+    }
+    replyLength = requestServer(path, SERVER_CLUSTER_SUBSET, name, strlen(name), outOfRange, 4, reply, 64);
+    if (replyLength != 1 || reply[0] != SERVER_BAD_REQUEST) {
+        result = 0;
+    }
+    replyLength = requestServer(path, SERVER_CLUSTER_SUBSET, name, strlen(name), repeated, 5, reply, 64);
+    if (replyLength != 1 || reply[0] != SERVER_BAD_REQUEST) {
+        result = 0;
+    }
+    replyLength = requestServer(path, SERVER_CLUSTER, name, SERVER_MAX_NAME_LENGTH + 1, seed, 2, reply, 64);
+    if (replyLength != 1 || reply[0] != SERVER_BAD_REQUEST) {
+        result = 0;
+    }
+
+    close(idle);
+    replyLength = requestServer(path, SERVER_SHUTDOWN, "", 0, NULL, 0, reply, 64);
+    if (replyLength != 1 || reply[0] != SERVER_OK) {
+        result = 0;
+    }
+    pthread_join(thread, NULL);
+    close(server.listener);
+    close(openServerSocket(path));
+    remove(path);
+
+    file = fopen(path, "w");
+    assertFileOpen(file, path);
+    fclose(file);
+    if (!isServerSocketRejected(path) || access(path, F_OK) != 0) {
+        result = 0;
+    }
+    remove(path);
+
+    deepFreeGroupList(groupLst);
+    destroyGraph(graph.G);
+    free(expected);
+    free(adjMatrix);
+    return result;
+}
+
+/**
+ * Divides a graph by its reduced graph of twin classes, and expands the division back.
+ * The modularity of the reduced division should equal the modularity of its expansion, and be no lower than the
+ * modularity of a division of the graph itself.
+ * @param adjMatrix the adjacency matrix of the graph.
+ * @param n the number of vertices.
+ * @param classesCount the expected number of twin classes.
+ * @param result will be assigned 0 if a check fails.
+ * @return the expanded division, with the groups and their vertices in increasing order.
+ */
+static LinkedList *divideByTwinClasses(double *adjMatrix, int n, int classesCount, char *result) {
+    double reducedModularity, modularity, plainModularity;
+    DivisionSettings settings;
+    TwinClasses *classes;
+    LinkedList *groupLst, *plainLst;
+    Graph *G = constructGraphFromMatrix(adjMatrix, n), *reduced;
+    int i, vertices = 0;
+    LinkedListNode *node;
+
+    classes = findTwinClasses(G);
+    reduced = compressTwins(G, classes);
+    initDivisionSettings(&settings);
+    restrictSettingsToWeights(&settings);
+    groupLst = divisionAlgorithm(reduced, &settings);
+    reducedModularity = evaluateDivisionModularity(reduced, groupLst);
+    expandTwins(groupLst, classes);
+    sortGroupVertices(groupLst);
+    sortGroupList(groupLst);
+    modularity = evaluateDivisionModularity(G, groupLst);
+
+    initDivisionSettings(&settings);
+    plainLst = divisionAlgorithm(G, &settings);
+    plainModularity = evaluateDivisionModularity(G, plainLst);
+    printf("Vertices: %d, classes: %d, modularity: %f, expanded: %f, without twins: %f\n", n, classes->count,
+           reducedModularity, modularity, plainModularity);
+
+    for (i = 0, node = groupLst->first; i < groupLst->length; ++i, node = node->next) {
+        vertices += ((VerticesGroup *) node->pointer)->size;
+    }
+    if (classes->count != classesCount || reduced->degreeSum != G->degreeSum || vertices != n ||
+        fabs(reducedModularity - modularity) > 1e-9 || modularity < plainModularity - 1e-9) {
+        *result = 0;
+    }
+
+    deepFreeGroupList(plainLst);
+    freeTwinClasses(classes);
+    destroyGraph(reduced);
+    destroyGraph(G);
+    return groupLst;
+}
+
+/**
+ * Divides graphs of connected hubs whose leaves are twins, by their reduced graphs.
+ * Two hubs with five leaves each should be divided into the two stars. A ring of 80 hubs with three leaves each
+ * reduces to 160 vertices, above the dense threshold, so its reduced graph is divided by the sparse engine.
+ * @return 0-if the test fails. 1-otherwise.
+ */
+char testTwinCompression() {
+    int n = 12, leaves = 5, ringHubs = 80, ringLeaves = 3, h, i, hub, next;
+    double *adjMatrix = calloc(n * n, sizeof(double));
+    LinkedList *groupLst;
+    LinkedListNode *node;
+    VerticesGroup *group;
+    char result = 1;
+    assertMemoryAllocation(adjMatrix);
+
+    /* two connected hubs, 0 and 6, each with five leaves, which are twins */
+    for (h = 0; h < 2; ++h) {
+        hub = h * (leaves + 1);
+        for (i = hub + 1; i <= hub + leaves; ++i) {
+            adjMatrix[hub * n + i] = adjMatrix[i * n + hub] = 1;
+        }
+    }
+    adjMatrix[leaves + 1] = adjMatrix[(leaves + 1) * n] = 1;
+    /* the two stars, {0, ..., 5} and {6, ..., 11} */
+    groupLst = divideByTwinClasses(adjMatrix, n, 4, &result);
+    if (groupLst->length != 2) {
+        result = 0;
+    }
+    for (h = 0, node = groupLst->first; h < groupLst->length; ++h, node = node->next) {
+        group = node->pointer;
+        if (group->size != leaves + 1) {
+            result = 0;
+            continue;
+        }
+        for (i = 0; i < group->size; ++i) {
+            if (group->verticesArr[i] != h * (leaves + 1) + i) {
+                result = 0;
+            }
+        }
+    }
+    deepFreeGroupList(groupLst);
+    free(adjMatrix);
+
+    /* a ring of hubs, every hub followed by its leaves */
+    n = ringHubs * (ringLeaves + 1);
+    adjMatrix = calloc(n * n, sizeof(double));
+    assertMemoryAllocation(adjMatrix);
+    for (h = 0; h < ringHubs; ++h) {
+        hub = h * (ringLeaves + 1);
+        next = (h + 1) % ringHubs * (ringLeaves + 1);
+        adjMatrix[hub * n + next] = adjMatrix[next * n + hub] = 1;
+        for (i = hub + 1; i <= hub + ringLeaves; ++i) {
+            adjMatrix[hub * n + i] = adjMatrix[i * n + hub] = 1;
+        }
+    }
+    groupLst = divideByTwinClasses(adjMatrix, n, 2 * ringHubs, &result);
+    deepFreeGroupList(groupLst);
+    free(adjMatrix);
+    return result;
+}
+
 int main() {
     srand(time(0));
+    printf("Testing the exact solver.\n");
+    printf("Result: %d\n", testExactDivision());
+    printf("Testing the sparse matrix formats.\n");
+    printf("Result: %d\n", testSparseFormats());
+    printf("Testing the merge-path format on shared rows.\n");
+    printf("Result: %d\n", testMergePathSharedRows());
+    printf("Testing the multi-way division.\n");
+    printf("Result: %d\n", testMultiwayDivision());
+    printf("Testing the checkpoint file format.\n");
+    printf("Result: %d\n", testCheckpoint());
+    printf("Testing the clustering server.\n");
+    printf("Result: %d\n", testServer());
+    printf("Testing the twin-vertex compression.\n");
+    printf("Result: %d\n", testTwinCompression());
     /*for (i = 0; i < 10; i++) {
         testMatrixMult();
     }
@@ -0,0 +1,225 @@
+#include <stdlib.h>
+#include "twins.h"
+#include "spmat.h"
+#include "VerticesGroup.h"
+#include "output.h"
+#include "ErrorHandler.h"
+
+/* the multiplier of the neighbor lists' hash */
+#define TWIN_HASH_MULTIPLIER 1000003UL
+
+typedef struct _twinKey {
+    unsigned long hash;
+    int degree;
+    int vertex;
+    nodeRef row;
+} TwinKey;
+
+/**
+ * Order vertices by the hash, the length and the contents of their neighbor lists, and then by their index.
+ * Twins are therefore consecutive, in increasing order.
+ */
+static int compareTwinKeys(const void *a, const void *b) {
+    const TwinKey *x = (const TwinKey *) a, *y = (const TwinKey *) b;
+    nodeRef first, second;
+    if (x->hash != y->hash) {
+        return x->hash < y->hash ? -1 : 1;
+    }
+    if (x->degree != y->degree) {
+        return x->degree < y->degree ? -1 : 1;
+    }
+    for (first = x->row, second = y->row; first != NULL; first = first->next, second = second->next) {
+        if (first->colind != second->colind) {
+            return first->colind < second->colind ? -1 : 1;
+        }
+    }
+    return (x->vertex > y->vertex) - (x->vertex < y->vertex);
+}
+
+/**
+ * Check whether two vertices, consecutive in the order of compareTwinKeys, are twins.
+ */
+static int areTwins(const TwinKey *x, const TwinKey *y) {
+    nodeRef first, second;
+    if (x->hash != y->hash || x->degree != y->degree || x->degree == 0) {
+        return 0;
+    }
+    for (first = x->row, second = y->row; first != NULL; first = first->next, second = second->next) {
+        if (first->colind != second->colind) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Find the classes of twin vertices of a graph, by hashing their sorted neighbor lists.
+ * Vertices without neighbors are never twins, so every one of them stays a group of its own.
+ * @param G graph object, whose edges all weigh 1
+ * @return the classes, numbered in the order of their first vertices, or NULL if no two vertices are twins
+ */
+TwinClasses *findTwinClasses(Graph *G) {
+    nodeRef *rows = (nodeRef *) G->adjMat->private;
+    nodeRef neighbor;
+    TwinClasses *classes;
+    TwinKey *keys = malloc(G->n * sizeof(TwinKey));
+    int i, count = 0, *representatives = malloc(G->n * sizeof(int));
+    assertMemoryAllocation(keys);
+    assertMemoryAllocation(representatives);
+
+    for (i = 0; i < G->n; i++) {
+        keys[i].hash = 0;
+        for (neighbor = rows[i]; neighbor != NULL; neighbor = neighbor->next) {
+            keys[i].hash = keys[i].hash * TWIN_HASH_MULTIPLIER + (unsigned long) neighbor->colind + 1;
+        }
+        keys[i].degree = G->degrees[i];
+        keys[i].vertex = i;
+        keys[i].row = rows[i];
+    }
+    qsort(keys, G->n, sizeof(TwinKey), compareTwinKeys);
+    /* every vertex is represented by the first of its twins */
+    for (i = 0; i < G->n; i++) {
+        representatives[keys[i].vertex] = i > 0 && areTwins(&keys[i - 1], &keys[i]) ?
+                                          representatives[keys[i - 1].vertex] : keys[i].vertex;
+    }
+    free(keys);
+    for (i = 0; i < G->n; i++) {
+        count += representatives[i] == i;
+    }
+    if (count == G->n) {
+        free(representatives);
+        return NULL;
+    }
+
+    classes = malloc(sizeof(TwinClasses));
+    assertMemoryAllocation(classes);
+    classes->n = G->n;
+    classes->count = count;
+    classes->offsets = calloc(count + 1, sizeof(int));
+    assertMemoryAllocation(classes->offsets);
+    classes->members = malloc(G->n * sizeof(int));
+    assertMemoryAllocation(classes->members);
+    /* representatives are replaced by the numbers of their classes, which come before any of their twins */
+    count = 0;
+    for (i = 0; i < G->n; i++) {
+        representatives[i] = representatives[i] == i ? count++ : representatives[representatives[i]];
+        classes->offsets[representatives[i] + 1]++;
+    }
+    for (i = 0; i < count; i++) {
+        classes->offsets[i + 1] += classes->offsets[i];
+    }
+    for (i = 0; i < G->n; i++) {
+        classes->members[classes->offsets[representatives[i]]++] = i;
+    }
+    /* every offset was moved to the next class's one */
+    for (i = count; i > 0; i--) {
+        classes->offsets[i] = classes->offsets[i - 1];
+    }
+    classes->offsets[0] = 0;
+    free(representatives);
+    return classes;
+}
+
+/**
+ * Construct the reduced graph of twin classes, with a vertex per class and weighted edges (see twins.h).
+ * @param G graph object, whose edges all weigh 1
+ * @param classes the twin classes of the graph, as found by findTwinClasses
+ * @return a new graph object of classes->count vertices (to be freed by destroyGraph)
+ */
+Graph *compressTwins(Graph *G, TwinClasses *classes) {
+    nodeRef *rows = (nodeRef *) G->adjMat->private;
+    nodeRef neighbor;
+    Graph *reduced = malloc(sizeof(Graph));
+    int r, i, size, *classOf = malloc(G->n * sizeof(int));
+    double *row = calloc(classes->count, sizeof(double));
+    assertMemoryAllocation(reduced);
+    assertMemoryAllocation(classOf);
+    assertMemoryAllocation(row);
+    reduced->n = classes->count;
+    reduced->degreeSum = G->degreeSum;
+    reduced->degrees = malloc(classes->count * sizeof(int));
+    assertMemoryAllocation(reduced->degrees);
+    reduced->originalIndices = NULL;
+    reduced->adjMat = spmat_allocate_list(classes->count);
+
+    for (r = 0; r < classes->count; r++) {
+        for (i = classes->offsets[r]; i < classes->offsets[r + 1]; i++) {
+            classOf[classes->members[i]] = r;
+        }
+    }
+    for (r = 0; r < classes->count; r++) {
+        /* the first twin stands for all of them, each of its neighbors adds an edge of every twin */
+        i = classes->members[classes->offsets[r]];
+        size = classes->offsets[r + 1] - classes->offsets[r];
+        reduced->degrees[r] = size * G->degrees[i];
+        for (neighbor = rows[i]; neighbor != NULL; neighbor = neighbor->next) {
+            row[classOf[neighbor->colind]] += size;
+        }
+        reduced->adjMat->add_row(reduced->adjMat, row, r);
+        for (neighbor = rows[i]; neighbor != NULL; neighbor = neighbor->next) {
+            row[classOf[neighbor->colind]] = 0;
+        }
+    }
+    free(row);
+    free(classOf);
+    return reduced;
+}
+
+/**
+ * Replace the classes in a division of the reduced graph by their twins.
+ * The vertices of every group are sorted in increasing order.
+ * @param groupLst list of vertices groups of the reduced graph, will be assigned the original vertices
+ * @param classes the twin classes, by which the graph was reduced
+ */
+void expandTwins(LinkedList *groupLst, TwinClasses *classes) {
+    LinkedListNode *currentNode = groupLst->first;
+    VerticesGroup *currentGroup;
+    int i, j, k, size, *vertices;
+    for (i = 0; i < groupLst->length; ++i) {
+        currentGroup = currentNode->pointer;
+        size = 0;
+        for (j = 0; j < currentGroup->size; ++j) {
+            size += classes->offsets[currentGroup->verticesArr[j] + 1] - classes->offsets[currentGroup->verticesArr[j]];
+        }
+        vertices = malloc(size * sizeof(int));
+        assertMemoryAllocation(vertices);
+        size = 0;
+        for (j = 0; j < currentGroup->size; ++j) {
+            for (k = classes->offsets[currentGroup->verticesArr[j]];
+                 k < classes->offsets[currentGroup->verticesArr[j] + 1]; ++k) {
+                vertices[size++] = classes->members[k];
+            }
+        }
+        free(currentGroup->verticesArr);
+        currentGroup->verticesArr = vertices;
+        currentGroup->size = size;
+        currentGroup->capacity = size;
+        currentNode = currentNode->next;
+    }
+    sortGroupVertices(groupLst);
+}
+
+/**
+ * Free memory allocated for twin classes
+ * @param classes
+ */
+void freeTwinClasses(TwinClasses *classes) {
+    free(classes->offsets);
+    free(classes->members);
+    free(classes);
+}
+
+/**
+ * Turn off the parts of the division which assume that every edge weighs 1, for dividing a reduced graph:
+ * the bit matrix and the compressed formats keep only the pattern of the edges, the prechecks prove cliques and
+ * stars indivisible by counting edges, and the multi-way refinement counts the neighbors in every part.
+ * @param settings division settings
+ */
+void restrictSettingsToWeights(DivisionSettings *settings) {
+    settings->bitsetDensity = 0;
+    if (settings->storage == STORAGE_COMPRESSED) {
+        settings->storage = STORAGE_LISTS;
+    }
+    settings->preChecks = 0;
+    settings->splitVectors = 0;
+}
@@ -0,0 +1,37 @@
+#ifndef CLUSTER_TWINS_H
+#define CLUSTER_TWINS_H
+
+#include "graph.h"
+#include "LinkedList.h"
+#include "division.h"
+
+/*
+ * Compression of twin vertices: vertices with exactly the same (non-empty) list of neighbors, such as the leaves of
+ * a hub, are collapsed into a single super-vertex before the division, and expanded back in its result.
+ * Twins are never adjacent, so a super-vertex of m twins of degree k has degree m*k and no self-loop, and its edge to
+ * another super-vertex of m' twins weighs m*m' (every one of its twins is adjacent to every one of the other's).
+ * The modularity of a division of the reduced graph therefore equals the modularity of its expansion, exactly.
+ * The division keeps twins together, which the leading eigenvector does anyway, as their rows of B are equal.
+ */
+
+typedef struct _twinClasses {
+    /* the number of vertices of the original graph */
+    int n;
+    /* the number of classes, which are the vertices of the reduced graph */
+    int count;
+    /* the members of class r are members[offsets[r]] .. members[offsets[r + 1] - 1], in increasing order */
+    int *offsets;
+    int *members;
+} TwinClasses;
+
+TwinClasses *findTwinClasses(Graph *G);
+
+Graph *compressTwins(Graph *G, TwinClasses *classes);
+
+void expandTwins(LinkedList *groupLst, TwinClasses *classes);
+
+void freeTwinClasses(TwinClasses *classes);
+
+void restrictSettingsToWeights(DivisionSettings *settings);
+
+#endif